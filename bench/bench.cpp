@@ -0,0 +1,60 @@
+#include "bench.h"
+
+#include <iostream>
+
+Bench::Bench(std::chrono::milliseconds a_min_time, const std::string& a_filter) :
+    min_time {a_min_time},
+    filter {a_filter},
+    results {} {}
+
+void Bench::run(const std::string& name, size_t size, const std::function<void ()>& op) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) {
+        return;
+    }
+
+    using clock = std::chrono::steady_clock;
+
+    op();
+
+    u_int64_t iterations = 0;
+    u_int64_t batch = 1;
+    clock::duration elapsed {};
+    while (elapsed < min_time) {
+        auto start = clock::now();
+        for (u_int64_t i = 0; i < batch; i++) {
+            op();
+        }
+        elapsed += clock::now() - start;
+        iterations += batch;
+        batch *= 2;
+    }
+
+    auto ns_per_op = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    results.push_back(BenchResult {
+        .name = name,
+        .size = size,
+        .iterations = iterations,
+        .ns_per_op = ns_per_op,
+        .items_per_sec = size * 1e9 / ns_per_op
+    });
+
+    std::cerr << name << " [" << size << "]: " << ns_per_op << " ns/op" << std::endl;
+}
+
+const std::vector<BenchResult>& Bench::get_results() const {
+    return results;
+}
+
+void Bench::print_json(std::ostream& out) const {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        auto& result = results[i];
+        out << "  {\"name\": \"" << result.name << "\""
+            << ", \"size\": " << result.size
+            << ", \"iterations\": " << result.iterations
+            << ", \"ns_per_op\": " << result.ns_per_op
+            << ", \"items_per_sec\": " << result.items_per_sec << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]" << std::endl;
+}
@@ -0,0 +1,40 @@
+#ifndef SECURITIES_SCANNER_BENCH_BENCH_H
+#define SECURITIES_SCANNER_BENCH_BENCH_H
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct BenchResult {
+    std::string name;
+    size_t size;
+    u_int64_t iterations;
+    double ns_per_op;
+    double items_per_sec;
+};
+
+// Runs each case until it has taken at least min_time and reports the mean.
+// A case processes `size` items per call; names not containing the filter are skipped.
+class Bench {
+    public:
+        Bench(std::chrono::milliseconds min_time, const std::string& filter);
+
+        void run(const std::string& name, size_t size, const std::function<void ()>& op);
+
+        const std::vector<BenchResult>& get_results() const;
+        void print_json(std::ostream& out) const;
+    private:
+        const std::chrono::milliseconds min_time;
+        const std::string filter;
+        std::vector<BenchResult> results;
+};
+
+// Keeps the compiler from dropping a computation whose result is otherwise unused
+template<typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+#endif // SECURITIES_SCANNER_BENCH_BENCH_H
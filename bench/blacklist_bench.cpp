@@ -0,0 +1,68 @@
+#include "bench.h"
+#include "universe.h"
+
+#include <storage.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+
+constexpr int BLACKLIST_READERS = 3;
+
+void bench_blacklist(Bench& bench, const std::vector<size_t>& sizes) {
+    for (auto size : sizes) {
+        auto universe = make_universe(size, 42);
+        auto table = make_bond_table(universe.bonds);
+        auto other_table = make_bond_table(universe.bonds);
+        auto blacklist = Blacklist(table);
+
+        // Every tenth bond blacklisted, lookups in random order
+        auto until = std::chrono::system_clock::now() + std::chrono::hours(1);
+        for (u_int32_t position = 0; position < size; position += 10) {
+            blacklist.set(position, 30.0, until);
+        }
+
+        auto random = std::mt19937 {42};
+        auto positions = std::vector<u_int32_t>(size);
+        for (u_int32_t position = 0; position < size; position++) {
+            positions[position] = position;
+        }
+        std::shuffle(positions.begin(), positions.end(), random);
+
+        auto lookup = [&](const BondTable& lookup_table) {
+            size_t found = 0;
+            for (auto position : positions) {
+                found += blacklist.get_max_ytm(lookup_table, position).has_value();
+            }
+            do_not_optimize(found);
+        };
+
+        bench.run("blacklist/get", size, [&]() { lookup(*table); });
+
+        // A table published after the blacklist maps positions through uids
+        bench.run("blacklist/get_other_table", size, [&]() { lookup(*other_table); });
+
+        // Lookups while other readers and a writer hit the same slots
+        {
+            std::atomic<bool> stop {false};
+            auto threads = std::vector<std::jthread>();
+            for (int i = 0; i < BLACKLIST_READERS; i++) {
+                threads.emplace_back([&]() {
+                    while (!stop.load(std::memory_order_relaxed)) {
+                        lookup(*table);
+                    }
+                });
+            }
+            threads.emplace_back([&]() {
+                u_int32_t position = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    blacklist.set(position, 30.0, until);
+                    position = (position + 7) % size;
+                }
+            });
+
+            bench.run("blacklist/get_contended", size, [&]() { lookup(*table); });
+            stop = true;
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#include "bench.h"
+#include "universe.h"
+
+#include <dto.h>
+#include <price_calc.h>
+#include <uuid_codec.h>
+#include <bond_table.h>
+#include <random>
+#include <boost/uuid/string_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+// Response of the last prices endpoint in the broker's layout
+std::string make_prices_json(const PriceMap& prices) {
+    auto json = std::string("{\"lastPrices\":[");
+    bool first = true;
+    for (auto& entry : prices) {
+        json += first ? "" : ",";
+        first = false;
+        json += "{\"figi\":\"BBG000000000\",\"price\":{\"units\":\"";
+        json += std::to_string(entry.second / 100);
+        json += "\",\"nano\":";
+        json += std::to_string(entry.second % 100 * 10000000);
+        json += "},\"time\":\"2024-01-01T10:00:00.000Z\",\"instrumentUid\":\"";
+        json += format_uuid(entry.first);
+        json += "\",\"lastPriceType\":\"LAST_PRICE_EXCHANGE\"}";
+    }
+    json += "]}";
+    return json;
+}
+
+// What parse_prices did before the pull parser: a full document tree and
+// boost's uuid parser
+void parse_prices_jsoncpp(const std::string& json, PriceMap& prices) {
+    Json::Value root;
+    Json::Reader reader;
+    if (!reader.parse(json, root)) {
+        throw std::invalid_argument { "Unable to parse json" };
+    }
+
+    boost::uuids::string_generator gen;
+    for (auto& price : root["lastPrices"]) {
+        auto& quotation = price["price"];
+        auto units = std::stol(quotation["units"].asString());
+        auto nano = quotation["nano"].asInt64();
+        prices[gen(price["instrumentUid"].asString())] = calc_price(units, nano);
+    }
+}
+
+// What to_json(PriceRequest) did before it wrote the body directly
+std::string to_json_jsoncpp(const PriceRequest& request) {
+    Json::Value root;
+    Json::Value uids(Json::arrayValue);
+    for (unsigned int i = 0; i < request.instrument_id.size(); i++) {
+        uids[i] = boost::uuids::to_string(request.instrument_id[i]);
+    }
+    root["instrumentId"] = uids;
+    Json::FastWriter writer;
+    return writer.write(root);
+}
+
+void bench_dto(Bench& bench, const std::vector<size_t>& sizes) {
+    for (auto size : sizes) {
+        auto universe = make_universe(size, 42);
+        auto table = make_bond_table(universe.bonds);
+        auto json = make_prices_json(universe.prices);
+
+        auto uids = std::vector<boost::uuids::uuid>();
+        auto uid_texts = std::vector<std::string>();
+        uids.reserve(size);
+        uid_texts.reserve(size);
+        for (auto& entry : universe.prices) {
+            uids.push_back(entry.first);
+            uid_texts.push_back(format_uuid(entry.first));
+        }
+
+        bench.run("dto/parse_prices", size, [&]() {
+            auto prices = PriceMap();
+            prices.reserve(size);
+            parse_prices(json, prices);
+            do_not_optimize(prices.size());
+        });
+
+        bench.run("dto/parse_prices_ids", size, [&]() {
+            auto prices = PricePoints();
+            prices.reserve(size);
+            parse_prices(json, table->ids, prices);
+            do_not_optimize(prices.data());
+        });
+
+        bench.run("dto/parse_prices_jsoncpp", size, [&]() {
+            auto prices = PriceMap();
+            prices.reserve(size);
+            parse_prices_jsoncpp(json, prices);
+            do_not_optimize(prices.size());
+        });
+
+        bench.run("dto/to_json_price_request", size, [&]() {
+            auto request = PriceRequest { .instrument_id = uids };
+            do_not_optimize(to_json(request));
+        });
+
+        bench.run("dto/to_json_price_request_jsoncpp", size, [&]() {
+            auto request = PriceRequest { .instrument_id = uids };
+            do_not_optimize(to_json_jsoncpp(request));
+        });
+
+        bench.run("dto/parse_uid", size, [&]() {
+            for (auto& text : uid_texts) {
+                do_not_optimize(parse_uid(text));
+            }
+        });
+
+        bench.run("dto/parse_uid_boost", size, [&]() {
+            boost::uuids::string_generator gen;
+            for (auto& text : uid_texts) {
+                do_not_optimize(gen(text.begin(), text.end()));
+            }
+        });
+
+        bench.run("dto/format_uuid", size, [&]() {
+            char out[UUID_TEXT_SIZE];
+            for (auto& uid : uids) {
+                format_uuid(uid, out);
+                do_not_optimize(out);
+            }
+        });
+
+        bench.run("dto/format_uuid_boost", size, [&]() {
+            for (auto& uid : uids) {
+                do_not_optimize(boost::uuids::to_string(uid));
+            }
+        });
+
+        auto quotations = std::vector<std::pair<long, long>>();
+        auto random = std::mt19937 {42};
+        auto units = std::uniform_int_distribution<long> {0, 2000};
+        auto nano = std::uniform_int_distribution<long> {0, 999999999};
+        quotations.reserve(size);
+        for (size_t i = 0; i < size; i++) {
+            quotations.emplace_back(units(random), nano(random));
+        }
+
+        bench.run("dto/calc_price", size, [&]() {
+            long sum = 0;
+            for (auto& quotation : quotations) {
+                sum += calc_price(quotation.first, quotation.second);
+            }
+            do_not_optimize(sum);
+        });
+    }
+
+    auto book = std::string(
+        "{\"figi\":\"BBG000000000\",\"depth\":1,"
+        "\"bids\":[{\"price\":{\"units\":\"98\",\"nano\":450000000},\"quantity\":\"10\"}],"
+        "\"asks\":[{\"price\":{\"units\":\"98\",\"nano\":520000000},\"quantity\":\"4\"}],"
+        "\"lastPrice\":{\"units\":\"98\",\"nano\":500000000},"
+        "\"instrumentUid\":\"8e2b0325-0292-4654-8a18-4f63ed3b0e09\"}");
+    bench.run("dto/parse_book", 1, [&]() {
+        do_not_optimize(parse<BookResponse>(book));
+    });
+}
@@ -0,0 +1,45 @@
+#include "bench.h"
+
+#include <iostream>
+#include <boost/program_options.hpp>
+
+namespace opts = boost::program_options;
+
+void bench_ytm(Bench& bench, const std::vector<size_t>& sizes);
+void bench_dto(Bench& bench, const std::vector<size_t>& sizes);
+void bench_blacklist(Bench& bench, const std::vector<size_t>& sizes);
+void bench_notifier(Bench& bench, const std::vector<size_t>& sizes);
+
+int main(int argc, const char *argv[]) {
+    try {
+        opts::options_description desc{"Options"};
+        desc.add_options()
+            ("help", "Show options")
+            ("filter", opts::value<std::string>()->default_value(""), "Run only cases whose name contains this")
+            ("min-time-ms", opts::value<int>()->default_value(200), "Minimal time per case")
+            ("size", opts::value<std::vector<size_t>>()->multitoken(), "Universe sizes, 1000, 10000 and 100000 by default");
+
+        opts::variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << desc << std::endl;
+            return 0;
+        }
+
+        auto sizes = vm.count("size") ? vm["size"].as<std::vector<size_t>>() : std::vector<size_t> {1000, 10000, 100000};
+
+        Bench bench {std::chrono::milliseconds(vm["min-time-ms"].as<int>()), vm["filter"].as<std::string>()};
+        bench_ytm(bench, sizes);
+        bench_dto(bench, sizes);
+        bench_blacklist(bench, sizes);
+        bench_notifier(bench, sizes);
+
+        bench.print_json(std::cout);
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}
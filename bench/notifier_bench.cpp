@@ -0,0 +1,96 @@
+#include "bench.h"
+#include "universe.h"
+
+#include <message_format.h>
+#include <math.h>
+#include <regex>
+
+const std::string PRICE_TEMPLATE = "*{}* \\({}\\)\nYTM: {}%, DTM: {}, price: {}%\n\n";
+
+// What alert rendering did before templates were compiled: a regex per name
+// and vformat for every number and line
+const std::regex markdown_specials_pattern("[_\\,\\*\\[\\]\\(\\)\\~>\\#\\+\\-=\\|\\{\\}\\.\\!]");
+
+std::string format_double_vformat(const double val) {
+    double int_part;
+    double fract_part = modf(val , &int_part);
+    int int_part_value = std::trunc(int_part);
+    int fract_part_value = std::trunc(fract_part * 100);
+    return std::vformat("{:d}\\.{:02d}", std::make_format_args(int_part_value, fract_part_value));
+}
+
+std::string format_price_lines_vformat(const std::string& price_template, const std::vector<BondYield>& prices) {
+    std::string message;
+    for (auto& price : prices) {
+        message += std::vformat(price_template, std::make_format_args(
+            std::regex_replace(price.name, markdown_specials_pattern, "\\-"),
+            price.isin,
+            format_double_vformat(price.ytm),
+            price.dtm,
+            format_double_vformat(price.price)
+        ));
+    }
+    return message;
+}
+
+void bench_notifier(Bench& bench, const std::vector<size_t>& sizes) {
+    auto price_template = MessageTemplate {PRICE_TEMPLATE, 5};
+
+    for (auto size : sizes) {
+        auto universe = make_universe(size, 42);
+        auto prices = std::vector<BondYield>();
+        prices.reserve(size);
+        for (auto& entry : *universe.bonds) {
+            auto& bond = entry.second;
+            prices.push_back(BondYield {
+                .isin = bond.isin,
+                .uid = bond.uid,
+                .name = bond.name + " (ПАО \"Компания\") 1-Р-01",
+                .ytm = 21.37,
+                .dtm = bond.dtm,
+                .price = 97.45
+            });
+        }
+
+        std::string lines;
+        bench.run("notifier/append_price_lines", size, [&]() {
+            lines.clear();
+            for (auto& price : prices) {
+                append_price_line(lines, price_template, price);
+            }
+            do_not_optimize(lines);
+        });
+
+        bench.run("notifier/format_price_lines_vformat", size, [&]() {
+            do_not_optimize(format_price_lines_vformat(PRICE_TEMPLATE, prices));
+        });
+
+        std::string name;
+        bench.run("notifier/append_sanitized", size, [&]() {
+            for (auto& price : prices) {
+                name.clear();
+                append_sanitized(name, price.name);
+                do_not_optimize(name);
+            }
+        });
+
+        bench.run("notifier/sanitize_text_regex", size, [&]() {
+            for (auto& price : prices) {
+                do_not_optimize(std::regex_replace(price.name, markdown_specials_pattern, "\\-"));
+            }
+        });
+
+        NumberBuffer buffer;
+        bench.run("notifier/format_double", size, [&]() {
+            for (auto& price : prices) {
+                do_not_optimize(format_double(buffer, price.ytm + price.dtm));
+            }
+        });
+
+        bench.run("notifier/format_double_vformat", size, [&]() {
+            for (auto& price : prices) {
+                do_not_optimize(format_double_vformat(price.ytm + price.dtm));
+            }
+        });
+    }
+}
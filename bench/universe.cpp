@@ -0,0 +1,44 @@
+#include "universe.h"
+
+#include <random>
+#include <boost/uuid/random_generator.hpp>
+
+Universe make_universe(size_t size, u_int32_t seed) {
+    auto random = std::mt19937 {seed};
+    auto uid_generator = boost::uuids::basic_random_generator<std::mt19937> {random};
+    auto nominal = std::uniform_int_distribution<int> {1, 10};
+    auto coupon = std::uniform_int_distribution<long> {0, 15000};
+    auto dtm = std::uniform_int_distribution<int> {1, 3650};
+    auto price = std::uniform_int_distribution<long> {600000, 1100000};
+
+    auto bonds = std::make_shared<UidsMap<BondInfo>>();
+    auto prices = PriceMap();
+    bonds->reserve(size);
+    prices.reserve(size);
+
+    auto now = std::chrono::system_clock::now();
+    for (size_t i = 0; i < size; i++) {
+        auto uid = uid_generator();
+        auto bond_nominal = nominal(random) * 100000L;
+        auto bond_dtm = dtm(random);
+        auto accured_interest = coupon(random) / 2;
+        auto cash_flow = bond_nominal + coupon(random) * (bond_dtm / 182 + 1);
+
+        bonds->insert({uid, BondInfo {
+            .isin = "RU" + std::to_string(1000000000 + i),
+            .uid = uid,
+            .name = "Bond " + std::to_string(i),
+            .accured_interest = accured_interest,
+            .nominal = bond_nominal,
+            .cash_flow = cash_flow,
+            .dtm = bond_dtm,
+            .loaded = now,
+            .fetched = now,
+            .next_coupon_date = now + std::chrono::days(bond_dtm % 182 + 1),
+            .next_coupon = coupon(random)
+        }});
+        prices.insert({uid, price(random)});
+    }
+
+    return Universe { .bonds = std::move(bonds), .prices = std::move(prices) };
+}
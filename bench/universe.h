@@ -0,0 +1,16 @@
+#ifndef SECURITIES_SCANNER_BENCH_UNIVERSE_H
+#define SECURITIES_SCANNER_BENCH_UNIVERSE_H
+
+#include <bond_table.h>
+#include <sscan/price_loader.h>
+#include <memory>
+
+// Synthetic bond universe with prices around par, same seed gives the same universe
+struct Universe {
+    std::shared_ptr<const UidsMap<BondInfo>> bonds;
+    PriceMap prices;
+};
+
+Universe make_universe(size_t size, u_int32_t seed);
+
+#endif // SECURITIES_SCANNER_BENCH_UNIVERSE_H
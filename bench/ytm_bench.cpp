@@ -0,0 +1,137 @@
+#include "bench.h"
+#include "universe.h"
+
+#include <bond_table.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SSCAN_BENCH_AVX2
+#endif
+
+constexpr double MIN_YTM = 20.0;
+constexpr double MIN_DTM = 60;
+
+namespace {
+
+#ifdef SSCAN_BENCH_AVX2
+
+    // Baseline: calc_ytm over the whole table four bonds at a time, with the
+    // same operations in the same order. Returns the first position left for
+    // a scalar tail.
+    __attribute__((target("avx2")))
+    size_t table_avx2(const BondTable& table, const double* prices, double* ytm, u_int8_t* pass) {
+        const __m256d price_scale = _mm256_set1_pd(10000.0);
+        const __m256d one = _mm256_set1_pd(1.0);
+        const __m256d year = _mm256_set1_pd(365.0);
+        const __m256d percent = _mm256_set1_pd(100.0);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d min_ytm = _mm256_set1_pd(MIN_YTM);
+        const __m256d min_dtm = _mm256_set1_pd(MIN_DTM);
+
+        size_t i = 0;
+        for (; i + 4 <= table.size(); i += 4) {
+            auto price = _mm256_loadu_pd(prices + i);
+            auto dtm = _mm256_loadu_pd(table.dtm.data() + i);
+
+            auto value = _mm256_mul_pd(_mm256_div_pd(price, price_scale), _mm256_loadu_pd(table.nominal.data() + i));
+            auto growth = _mm256_div_pd(
+                _mm256_loadu_pd(table.cash_flow.data() + i),
+                _mm256_add_pd(value, _mm256_loadu_pd(table.accured_interest.data() + i)));
+            auto result = _mm256_mul_pd(_mm256_div_pd(_mm256_mul_pd(_mm256_sub_pd(growth, one), year), dtm), percent);
+            _mm256_storeu_pd(ytm + i, result);
+
+            auto mask = _mm256_and_pd(
+                _mm256_and_pd(_mm256_cmp_pd(price, zero, _CMP_GT_OQ), _mm256_cmp_pd(dtm, min_dtm, _CMP_GE_OQ)),
+                _mm256_cmp_pd(result, min_ytm, _CMP_GE_OQ));
+            auto bits = _mm256_movemask_pd(mask);
+            pass[i] = bits & 1;
+            pass[i + 1] = (bits >> 1) & 1;
+            pass[i + 2] = (bits >> 2) & 1;
+            pass[i + 3] = (bits >> 3) & 1;
+        }
+
+        return i;
+    }
+
+#endif
+
+}
+
+void bench_ytm(Bench& bench, const std::vector<size_t>& sizes) {
+    for (auto size : sizes) {
+        auto universe = make_universe(size, 42);
+        auto& bonds = *universe.bonds;
+        auto& prices = universe.prices;
+        auto table = make_bond_table(universe.bonds);
+        auto ceilings = make_price_ceilings(table, MIN_YTM, MIN_DTM);
+
+        auto price_column = std::vector<double>(size);
+        auto ytm_column = std::vector<double>(size);
+        auto pass_column = std::vector<u_int8_t>(size);
+        for (auto& entry : prices) {
+            price_column[table->ids.find(entry.first)] = entry.second;
+        }
+
+        // Row layout: every price looks its bond up in the map
+        bench.run("ytm/map_loop", size, [&]() {
+            size_t passed = 0;
+            for (auto& entry : prices) {
+                auto& bond = bonds.find(entry.first)->second;
+                if (bond.dtm < MIN_DTM) {
+                    continue;
+                }
+                auto price = entry.second / 10000.0 * bond.nominal;
+                auto ytm = (bond.cash_flow / (price + bond.accured_interest) - 1) * 365.0 / bond.dtm * 100;
+                passed += ytm >= MIN_YTM;
+            }
+            do_not_optimize(passed);
+        });
+
+        bench.run("ytm/table_scatter", size, [&]() {
+            for (auto& entry : prices) {
+                price_column[table->ids.find(entry.first)] = entry.second;
+            }
+            do_not_optimize(price_column.data());
+        });
+
+        bench.run("ytm/table_scalar", size, [&]() {
+            for (size_t i = 0; i < size; i++) {
+                ytm_column[i] = calc_ytm(price_column[i], table->nominal[i], table->cash_flow[i], table->accured_interest[i], table->dtm[i]);
+                pass_column[i] = price_column[i] > 0 && table->dtm[i] >= MIN_DTM && ytm_column[i] >= MIN_YTM;
+            }
+            do_not_optimize(pass_column.data());
+        });
+
+#ifdef SSCAN_BENCH_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+            bench.run("ytm/table_avx2", size, [&]() {
+                auto i = table_avx2(*table, price_column.data(), ytm_column.data(), pass_column.data());
+                for (; i < size; i++) {
+                    ytm_column[i] = calc_ytm(price_column[i], table->nominal[i], table->cash_flow[i], table->accured_interest[i], table->dtm[i]);
+                    pass_column[i] = price_column[i] > 0 && table->dtm[i] >= MIN_DTM && ytm_column[i] >= MIN_YTM;
+                }
+                do_not_optimize(pass_column.data());
+            });
+        }
+#endif
+
+        // Integer compare against the ceiling, full yield only for what passes
+        bench.run("ytm/table_ceiling", size, [&]() {
+            auto& ceiling = ceilings->ceiling;
+            size_t passed = 0;
+            for (size_t i = 0; i < size; i++) {
+                auto price = static_cast<long>(price_column[i]);
+                if (price <= 0 || price > ceiling[i]) {
+                    continue;
+                }
+                auto ytm = calc_ytm(price, table->nominal[i], table->cash_flow[i], table->accured_interest[i], table->dtm[i]);
+                passed += ytm >= MIN_YTM;
+            }
+            do_not_optimize(passed);
+        });
+
+        bench.run("ytm/make_ceilings", size, [&]() {
+            do_not_optimize(make_price_ceilings(table, MIN_YTM, MIN_DTM));
+        });
+    }
+}
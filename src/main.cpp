@@ -1,5 +1,8 @@
 #include <sscan/scanner.h>
 #include <sscan/notifier.h>
+#include <sscan/metrics.h>
+#include <sscan/telemetry_server.h>
+#include <sscan/trace.h>
 #include <iostream>
 #include <boost/program_options.hpp>
 
@@ -53,6 +56,29 @@ int main(int argc, const char *argv[]) {
 
         init_logging(config.log);
 
+        if (!config.http.record_path.empty()) {
+            http::Recorder::set_shared(std::make_shared<http::Recorder>(config.http.record_path));
+            BOOST_LOG_TRIVIAL(info) << "Recording HTTP exchanges to " << config.http.record_path;
+        }
+
+        TelemetryServer telemetry_server {config.telemetry.host, config.telemetry.port};
+        telemetry_server.route("/metrics", "text/plain; version=0.0.4", [](std::string_view) {
+            return metrics::Registry::shared().render();
+        });
+        // GET /trace dumps recent spans, ?enable=1, ?enable=0 and ?clear=1 control recording
+        trace::set_enabled(config.telemetry.trace);
+        telemetry_server.route("/trace", "application/json", [](std::string_view query) {
+            if (query == "enable=1" || query == "enable=0") {
+                trace::set_enabled(query == "enable=1");
+            } else if (query == "clear=1") {
+                trace::clear();
+            } else {
+                return trace::dump();
+            }
+            return std::string(trace::is_enabled() ? "{\"enabled\":true}" : "{\"enabled\":false}");
+        });
+        telemetry_server.start();
+
         BondsLoader bonds_loader {config};
         PriceLoader price_loader {config};
 
@@ -15,6 +15,7 @@ class RankConfig {
         const std::string path_template;
         const std::string regex;
         const int max_pages;
+        const int concurrency;
 };
 
 class BrokerConfig {
@@ -29,12 +30,23 @@ class BrokerConfig {
         const int instruments_rps;
         const int price_rps;
         const std::string timezone;
+        const int instruments_connections;
+        const int instruments_burst;
+        const int price_burst;
+        const int price_batch_size;
+        const int price_connections;
+        const int book_concurrency;
+        const int book_timeout_ms;
+        const std::string price_stream_host;
+        const std::string price_stream_port;
+        const std::string price_stream_path;
 };
 
 class TgBotConfig {
     public:
         const std::string token;
         const int64_t chat_id;
+        const std::string api_url;
         const std::string greeting_template;
         const std::string bonds_stats_template;
         const std::string price_template;
@@ -48,6 +60,37 @@ class TgBotConfig {
         const std::string holiday_success_template;
         const std::string holiday_fail_template;
         const std::string working_time_error_template;
+        const int chat_rps;
+        const int global_rps;
+        const size_t queue_size;
+        const int alert_max_age_ms;
+};
+
+class StorageConfig {
+    public:
+        const std::string snapshot_path;
+        const int full_refresh_days;
+};
+
+class ScannerConfig {
+    public:
+        const int price_interval_ms;
+        const std::string price_policy;
+        const int bonds_interval_ms;
+        const int state_interval_ms;
+        const bool ignore_working_hours;
+};
+
+class TelemetryConfig {
+    public:
+        const std::string host;
+        const int port;
+        const bool trace;
+};
+
+class HttpConfig {
+    public:
+        const std::string record_path;
 };
 
 class Config {
@@ -56,6 +99,10 @@ class Config {
         RankConfig rank;
         BrokerConfig broker;
         TgBotConfig tgbot;
+        StorageConfig storage;
+        ScannerConfig scanner;
+        TelemetryConfig telemetry;
+        HttpConfig http;
 
         static Config load(const std::string& path);
 };
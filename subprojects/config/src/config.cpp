@@ -16,12 +16,14 @@ Config Config::load(const std::string& file_name) {
         .host = rankNode["host"].as<std::string>(),
         .path_template = rankNode["path-template"].as<std::string>(),
         .regex = rankNode["regex"].as<std::string>(),
-        .max_pages = rankNode["max-pages"].as<int>()
+        .max_pages = rankNode["max-pages"].as<int>(),
+        .concurrency = rankNode["concurrency"].as<int>(4)
     };
 
     auto brokerNode = applicationNode["broker"];
+    auto brokerHost = brokerNode["host"].as<std::string>();
     BrokerConfig broker {
-        .host = brokerNode["host"].as<std::string>(),
+        .host = brokerHost,
         .auth = brokerNode["auth"].as<std::string>(),
         .metadata_path = brokerNode["metadata-path"].as<std::string>(),
         .interest_path = brokerNode["interest-path"].as<std::string>(),
@@ -31,12 +33,23 @@ Config Config::load(const std::string& file_name) {
         .instruments_rps = brokerNode["instruments-rps"].as<int>(),
         .price_rps = brokerNode["price-rps"].as<int>(),
         .timezone = brokerNode["timezone"].as<std::string>(),
+        .instruments_connections = brokerNode["instruments-connections"].as<int>(4),
+        .instruments_burst = brokerNode["instruments-burst"].as<int>(1),
+        .price_burst = brokerNode["price-burst"].as<int>(1),
+        .price_batch_size = brokerNode["price-batch-size"].as<int>(500),
+        .price_connections = brokerNode["price-connections"].as<int>(4),
+        .book_concurrency = brokerNode["book-concurrency"].as<int>(8),
+        .book_timeout_ms = brokerNode["book-timeout-ms"].as<int>(5000),
+        .price_stream_host = brokerNode["price-stream-host"].as<std::string>(brokerHost),
+        .price_stream_port = brokerNode["price-stream-port"].as<std::string>("443"),
+        .price_stream_path = brokerNode["price-stream-path"].as<std::string>(""),
     };
 
     auto tgbotNode = applicationNode["tgbot"];
     TgBotConfig tgbot {
         .token = tgbotNode["token"].as<std::string>(),
         .chat_id = tgbotNode["chat-id"].as<int64_t>(),
+        .api_url = tgbotNode["api-url"].as<std::string>("https://api.telegram.org"),
         .greeting_template = tgbotNode["greeting-template"].as<std::string>(),
         .bonds_stats_template = tgbotNode["bonds-stats-template"].as<std::string>(),
         .price_template = tgbotNode["price-template"].as<std::string>(),
@@ -50,7 +63,38 @@ Config Config::load(const std::string& file_name) {
         .holiday_success_template = tgbotNode["holiday-success-template"].as<std::string>(),
         .holiday_fail_template = tgbotNode["holiday-fail-template"].as<std::string>(),
         .working_time_error_template = tgbotNode["working-time-error-template"].as<std::string>(),
+        .chat_rps = tgbotNode["chat-rps"].as<int>(1),
+        .global_rps = tgbotNode["global-rps"].as<int>(30),
+        .queue_size = tgbotNode["queue-size"].as<size_t>(1000),
+        .alert_max_age_ms = tgbotNode["alert-max-age-ms"].as<int>(60000),
     };
 
-    return Config {log, rank, broker, tgbot};
+    auto storageNode = applicationNode["storage"];
+    StorageConfig storage {
+        .snapshot_path = storageNode["snapshot-path"].as<std::string>("bonds.snapshot"),
+        .full_refresh_days = storageNode["full-refresh-days"].as<int>(7),
+    };
+
+    auto scannerNode = applicationNode["scanner"];
+    ScannerConfig scanner {
+        .price_interval_ms = scannerNode["price-interval-ms"].as<int>(10000),
+        .price_policy = scannerNode["price-policy"].as<std::string>("skip"),
+        .bonds_interval_ms = scannerNode["bonds-interval-ms"].as<int>(60000),
+        .state_interval_ms = scannerNode["state-interval-ms"].as<int>(10000),
+        .ignore_working_hours = scannerNode["ignore-working-hours"].as<bool>(false),
+    };
+
+    auto telemetryNode = applicationNode["telemetry"];
+    TelemetryConfig telemetry {
+        .host = telemetryNode["host"].as<std::string>("127.0.0.1"),
+        .port = telemetryNode["port"].as<int>(0),
+        .trace = telemetryNode["trace"].as<bool>(false),
+    };
+
+    auto httpNode = applicationNode["http"];
+    HttpConfig http {
+        .record_path = httpNode["record-path"].as<std::string>(""),
+    };
+
+    return Config {log, rank, broker, tgbot, storage, scanner, telemetry, http};
 }
\ No newline at end of file
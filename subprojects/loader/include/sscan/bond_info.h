@@ -1,6 +1,7 @@
 #ifndef SECURITIES_SCANNER_BOND_INFO_H
 #define SECURITIES_SCANNER_BOND_INFO_H
 
+#include <chrono>
 #include <string>
 #include <boost/uuid/uuid.hpp>
 
@@ -13,6 +14,12 @@ class BondInfo {
         const long nominal;
         const long cash_flow;
         const int dtm;
+        // Base for aging the accrued interest and dtm, moves with every aging
+        const std::chrono::system_clock::time_point loaded;
+        // When the broker last returned the bond, aging keeps it
+        const std::chrono::system_clock::time_point fetched;
+        const std::chrono::system_clock::time_point next_coupon_date;
+        const long next_coupon;
 };
 
 #endif // SECURITIES_SCANNER_BOND_INFO_H
\ No newline at end of file
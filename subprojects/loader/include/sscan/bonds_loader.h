@@ -6,25 +6,35 @@
 #include <sscan/config.h>
 #include <sscan/http.h>
 #include <unordered_set>
-#include <regex>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
+class RankMatcher;
+
 class BondsLoader {
     public:
         BondsLoader(const Config& config);
+        ~BondsLoader();
 
         BondsLoader(const BondsLoader& other) = delete;
         BondsLoader& operator=(const BondsLoader& other) = delete;
 
         std::vector<BondInfo> load();
+        std::vector<BondInfo> load(const std::vector<std::string>& isins);
+        std::unordered_set<std::string> find_all();
     private:
+        using IsinConsumer = std::function<bool (const std::string& isin)>;
+
         const Config& config;
         http::HttpClient sl_client;
         http::HttpClient t_client;
-        const std::regex rank_regex;
+        const std::unique_ptr<const RankMatcher> rank_matcher;
 
         std::unordered_set<std::string> find(const int page);
+        void find_pages(const IsinConsumer& consumer);
+        std::vector<BondInfo> load_bonds(const std::function<void (const IsinConsumer&)>& producer);
         std::optional<BondInfo> load_bond(const std::string& isin);
 };
 
@@ -5,17 +5,81 @@
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
 #include <boost/beast.hpp>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <future>
 #include <string>
+#include <string_view>
 #include <memory>
-
-using socket_stream_t = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace http {
+
+    // io_context and TLS context shared by all clients, run by its own threads.
+    class IoContext {
+        public:
+            IoContext(const int threads);
+            ~IoContext();
+
+            IoContext(const IoContext& other) = delete;
+            IoContext& operator=(const IoContext& other) = delete;
+
+            boost::asio::io_context& get_io();
+            boost::asio::ssl::context& get_ssl();
+
+            static std::shared_ptr<IoContext> shared();
+        private:
+            boost::asio::io_context io;
+            boost::asio::ssl::context ssl;
+            boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+            std::vector<std::thread> threads;
+    };
+
+    struct Exchange {
+        std::string host;
+        std::string method;
+        std::string target;
+        std::string request;
+        unsigned int status;
+        std::string response;
+    };
+
+    // Appends completed exchanges to a file, one json object per line, for
+    // replay by tools/mock_broker. Clients record while a shared recorder is set.
+    class Recorder {
+        public:
+            explicit Recorder(const std::string& path);
+
+            Recorder(const Recorder& other) = delete;
+            Recorder& operator=(const Recorder& other) = delete;
+
+            void record(const Exchange& exchange);
+
+            static std::shared_ptr<Recorder> shared();
+            static void set_shared(std::shared_ptr<Recorder> recorder);
+        private:
+            std::mutex m;
+            std::ofstream out;
+    };
+
+    // Invoked on an IoContext thread with either an error or the response body.
+    using ResponseHandler = std::function<void (std::exception_ptr error, std::string body)>;
+
+    // Invoked on an IoContext thread with each piece of a successful response body as it is read.
+    using ChunkHandler = std::function<void (std::string_view chunk)>;
     
     class HttpClient {
         public:
-            HttpClient(const std::string& host);
-            HttpClient(const std::string& host, const std::string& auth, const int rps);
+            HttpClient(const std::string& host, const int max_connections = 1);
+            HttpClient(const std::string& host, const std::string& auth, const int rps, const int max_connections = 1);
+            HttpClient(
+                const std::string& host, 
+                const std::string& auth, 
+                std::shared_ptr<RateLimiter> rate_limiter, 
+                const int max_connections = 1);
             ~HttpClient();
 
             HttpClient(const HttpClient& other) = delete;
@@ -25,21 +89,36 @@ namespace http {
             HttpClient& operator=(HttpClient&& other) = default;
 
             std::string get(const std::string& path);
+            void get(const std::string& path, ChunkHandler on_chunk);
             std::string post(const std::string& path, const std::string& request);
 
+            std::future<std::string> async_get(const std::string& path);
+            std::future<std::string> async_post(const std::string& path, const std::string& request);
+
+            void async_get(const std::string& path, ResponseHandler handler);
+            void async_post(const std::string& path, const std::string& request, ResponseHandler handler);
+
             void shutdown();
         private:
-            const std::string host;
-            const std::string auth;
-            std::optional<RateLimiter> rate_limiter;
-            std::unique_ptr<boost::asio::io_service> service;
-            std::unique_ptr<socket_stream_t> ssl_socket_stream;
-
-            void connect();
-            std::string request(boost::beast::http::verb method, const std::string& path, const std::string& request);
+            class Pool;
+
+            std::shared_ptr<RateLimiter> rate_limiter;
+            std::shared_ptr<Pool> pool;
+
+            std::future<std::string> request(
+                boost::beast::http::verb method, 
+                const std::string& path, 
+                const std::string& request,
+                ChunkHandler on_chunk = {});
+            void request(
+                boost::beast::http::verb method, 
+                const std::string& path, 
+                const std::string& request, 
+                ResponseHandler handler,
+                ChunkHandler on_chunk = {});
     };
 
     class not_found : public std::exception {};
 }
 
-#endif // SECURITIES_SCANNER_HTTP_H
\ No newline at end of file
+#endif // SECURITIES_SCANNER_HTTP_H
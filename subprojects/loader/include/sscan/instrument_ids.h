@@ -0,0 +1,36 @@
+#ifndef SECURITIES_SCANNER_INSTRUMENT_IDS_H
+#define SECURITIES_SCANNER_INSTRUMENT_IDS_H
+
+#include <limits>
+#include <vector>
+#include <boost/uuid/uuid.hpp>
+
+// Interns instrument uids of one universe into dense ids 0..size-1, in the order
+// given. Built once per load, so per-cycle code can index arrays instead of
+// hashing uuids.
+class InstrumentIds {
+    public:
+        static constexpr u_int32_t NONE = std::numeric_limits<u_int32_t>::max();
+
+        InstrumentIds();
+        explicit InstrumentIds(std::vector<boost::uuids::uuid> uids);
+
+        // Returns NONE for uids outside the universe
+        u_int32_t find(const boost::uuids::uuid& uid) const;
+
+        const boost::uuids::uuid& uid(u_int32_t id) const {
+            return uids[id];
+        }
+
+        size_t size() const {
+            return uids.size();
+        }
+    private:
+        std::vector<boost::uuids::uuid> uids;
+        std::vector<u_int32_t> slots;
+        size_t mask;
+
+        size_t slot_of(const boost::uuids::uuid& uid) const;
+};
+
+#endif // SECURITIES_SCANNER_INSTRUMENT_IDS_H
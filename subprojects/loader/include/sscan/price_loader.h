@@ -3,6 +3,8 @@
 
 #include <sscan/config.h>
 #include <sscan/http.h>
+#include <sscan/instrument_ids.h>
+#include <functional>
 #include <unordered_map>
 #include <vector>
 #include <boost/functional/hash.hpp>
@@ -10,19 +12,50 @@
 #include <memory>
 
 using PriceMap = std::unordered_map<boost::uuids::uuid, long, boost::hash<boost::uuids::uuid>>;
+using PriceBatchHandler = std::function<void (PriceMap&& prices)>;
+
+struct PricePoint {
+    u_int32_t id;
+    long price;
+};
+using PricePoints = std::vector<PricePoint>;
+using PricePointHandler = std::function<void (PricePoints&& prices)>;
+
+class PriceStream;
 
 class PriceLoader {
     public:
         PriceLoader(const Config& config);
+        ~PriceLoader();
         
         PriceLoader(const PriceLoader& other) = delete;
         PriceLoader& operator=(const PriceLoader& other) = delete;
 
-        PriceMap load(const std::vector<boost::uuids::uuid>& uid);
-        long load_book_price(const boost::uuids::uuid& uid);
+        // Instruments are named by their ids, so batches need no uuid maps
+        void load(const InstrumentIds& ids, const std::vector<u_int32_t>& id, const PricePointHandler& handler);
+        // Ask prices in request order, 0 where none was loaded in time
+        std::vector<long> load_book_prices(const InstrumentIds& ids, const std::vector<u_int32_t>& id);
+
+        // Streams last price updates for the given instruments to the handler,
+        // replacing the previous subscription. Returns false when no price
+        // stream is configured and prices have to be polled.
+        bool subscribe(const std::vector<boost::uuids::uuid>& uid, const PriceBatchHandler& handler);
+        bool is_streaming() const;
+        u_int64_t get_stream_generation() const;
     private:
+        struct BookFetch;
+
         const Config& config;
         http::HttpClient client;
+        std::shared_ptr<PriceStream> stream;
+
+        template<typename Prices>
+        void load_batches(
+            const std::vector<boost::uuids::uuid>& uid,
+            const std::function<void (std::string_view json, Prices& prices)>& parse,
+            const std::function<void (Prices&& prices)>& handler);
+        std::shared_ptr<BookFetch> fetch_book_prices(std::vector<boost::uuids::uuid> uid);
+        void load_next_book_price(const std::shared_ptr<BookFetch>& fetch);
 };
 
-#endif // SECURITIES_SCANNER_PRICE_LOADER_H
\ No newline at end of file
+#endif // SECURITIES_SCANNER_PRICE_LOADER_H
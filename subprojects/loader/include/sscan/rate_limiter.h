@@ -1,27 +1,45 @@
 #ifndef SECURITIES_SCANNER_RATE_LIMITER_H
 #define SECURITIES_SCANNER_RATE_LIMITER_H
 
+#include <sscan/metrics.h>
+#include <boost/asio/io_context.hpp>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
 
 namespace http {
 
+    // Token bucket refilled at rps tokens per second and holding up to burst tokens.
+    // Every caller reserves its slot with a single CAS on the theoretical arrival
+    // time, so the limiter is lock-free and can be shared between any number of clients.
     class RateLimiter {
         public:
-            RateLimiter(const int rps);
+            RateLimiter(const int rps, const int burst = 1, const std::string& name = "default");
 
             RateLimiter(const RateLimiter& other) = delete;
             RateLimiter& operator=(const RateLimiter& other) = delete;
 
-            RateLimiter(RateLimiter&& other) = default;
-            RateLimiter& operator=(RateLimiter&& other) = default;
-
             void acquire();
+            void async_acquire(boost::asio::io_context& io, std::function<void ()> handler);
+            std::chrono::nanoseconds reserve();
+
+            // One limiter per quota name. Throws when the quota already has a
+            // limiter with other rps or burst.
+            static std::shared_ptr<RateLimiter> shared(const std::string& quota, const int rps, const int burst = 1);
         private:
             const int rps;
-            int requests;
-            std::chrono::system_clock::time_point last_reset;
+            const int burst;
+            const int64_t interval_ns;
+            const int64_t tolerance_ns;
+            std::atomic<int64_t> arrival_ns;
+
+            metrics::Histogram& wait_seconds;
+            metrics::Counter& throttled_total;
     };
     
 }
 
-#endif // SECURITIES_SCANNER_RATE_LIMITER_H
\ No newline at end of file
+#endif // SECURITIES_SCANNER_RATE_LIMITER_H
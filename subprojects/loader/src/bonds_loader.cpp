@@ -1,80 +1,227 @@
 #include <sscan/bonds_loader.h>
 
 #include "dto.h"
+#include "bounded_queue.h"
+#include "rank_matcher.h"
+
+#include <sscan/metrics.h>
+#include <sscan/trace.h>
 #include <iostream>
 #include <unordered_set>
 #include <format>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <boost/beast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/log/trivial.hpp>
 
 namespace beast = boost::beast;
 
+const size_t ISIN_QUEUE_CAPACITY = 256;
+
 BondsLoader::BondsLoader(const Config& a_config) : 
     config {a_config},
-    sl_client {http::HttpClient{config.rank.host}},
-    t_client {http::HttpClient{config.broker.host, config.broker.auth, config.broker.instruments_rps}},
-    rank_regex {std::regex {config.rank.regex}} {};
+    sl_client {http::HttpClient{config.rank.host, config.rank.concurrency}},
+    t_client {http::HttpClient{
+        config.broker.host, 
+        config.broker.auth, 
+        http::RateLimiter::shared(
+            config.broker.host + "/instruments", 
+            config.broker.instruments_rps, 
+            config.broker.instruments_burst),
+        config.broker.instruments_connections}},
+    rank_matcher {std::make_unique<const RankMatcher>(config.rank.regex)} {};
+
+BondsLoader::~BondsLoader() = default;
 
 std::vector<BondInfo> BondsLoader::load() {
-    auto result = std::vector<BondInfo>();
+    auto result = load_bonds([&](const IsinConsumer& consumer) { find_pages(consumer); });
+    sl_client.shutdown();
+
+    BOOST_LOG_TRIVIAL(debug) << "Total bonds loaded: " << std::to_string(result.size());
+
+    return result;
+}
+
+std::vector<BondInfo> BondsLoader::load(const std::vector<std::string>& isins) {
+    auto result = load_bonds([&](const IsinConsumer& consumer) {
+        for (auto& isin : isins) {
+            if (!consumer(isin)) {
+                return;
+            }
+        }
+    });
+
+    BOOST_LOG_TRIVIAL(debug) << "Bonds loaded: " << std::to_string(result.size()) 
+        << " of " << std::to_string(isins.size());
+
+    return result;
+}
+
+std::unordered_set<std::string> BondsLoader::find_all() {
+    std::mutex m;
+    auto isins = std::unordered_set<std::string>();
+
+    find_pages([&](const std::string& isin) {
+        std::lock_guard<std::mutex> lock(m);
+        isins.insert(isin);
+        return true;
+    });
+    sl_client.shutdown();
+
+    BOOST_LOG_TRIVIAL(debug) << "Total ISINs found: " << std::to_string(isins.size());
+
+    return isins;
+}
+
+void BondsLoader::find_pages(const IsinConsumer& consumer) {
     auto isins = std::unordered_set<std::string>();
 
-    for (int page = 1; page <= config.rank.max_pages; page++) {
-        BOOST_LOG_TRIVIAL(debug) << "Page: " << std::to_string(page);
+    std::mutex m;
+    std::exception_ptr error;
+    std::atomic<int> next_page {1};
+    std::atomic<int> last_page {config.rank.max_pages};
+
+    {
+        auto page_workers = std::vector<std::jthread>();
+        for (int i = 0; i < std::max(config.rank.concurrency, 1); i++) {
+            page_workers.emplace_back([&]() {
+                for (int page = next_page++; page <= last_page; page = next_page++) {
+                    BOOST_LOG_TRIVIAL(debug) << "Page: " << std::to_string(page);
+
+                    try {
+                        auto isin_set = find(page);
+                        if (isin_set.size() == 0) {
+                            int current_last = last_page;
+                            while (page - 1 < current_last && !last_page.compare_exchange_weak(current_last, page - 1)) {}
+                            return;
+                        }
 
-        auto isin_set = find(page);
-        sl_client.shutdown();
-        if (isin_set.size() == 0) {
-            break;
+                        for (auto& isin : isin_set) {
+                            {
+                                std::lock_guard<std::mutex> lock(m);
+                                if (page > last_page || !isins.insert(isin).second) {
+                                    continue;
+                                }
+                            }
+
+                            if (!consumer(isin)) {
+                                last_page = 0;
+                                return;
+                            }
+                        }
+                    } catch (...) {
+                        {
+                            std::lock_guard<std::mutex> lock(m);
+                            if (!error) {
+                                error = std::current_exception();
+                            }
+                        }
+                        last_page = 0;
+                        return;
+                    }
+                }
+            });
         }
+    }
 
-        for (auto& isin : isin_set) {
-            if (isins.contains(isin)) {
-                continue;
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::vector<BondInfo> BondsLoader::load_bonds(const std::function<void (const IsinConsumer&)>& producer) {
+    auto result = std::vector<BondInfo>();
+    auto isin_queue = BoundedQueue<std::string>(ISIN_QUEUE_CAPACITY);
+
+    static auto& in_progress = metrics::Registry::shared().gauge(
+        "sscan_reload_in_progress", "Whether bonds are being loaded").with({});
+    static auto& reload_isins = metrics::Registry::shared().gauge(
+        "sscan_reload_isins", "ISINs of the current bonds load by state", {"state"});
+    static auto& queued_isins = reload_isins.with({"queued"});
+    static auto& done_isins = reload_isins.with({"done"});
+    in_progress.set(1);
+    queued_isins.set(0);
+    done_isins.set(0);
+
+    std::mutex m;
+    std::exception_ptr error;
+
+    auto fail = [&](std::exception_ptr ex) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (!error) {
+                error = ex;
             }
+        }
+        isin_queue.cancel();
+    };
+
+    auto bond_workers = std::vector<std::jthread>();
+    for (int i = 0; i < std::max(config.broker.instruments_connections, 1); i++) {
+        bond_workers.emplace_back([&]() {
+            while (auto isin = isin_queue.pop()) {
+                try {
+                    auto bond = load_bond(isin.value());
+                    done_isins.add(1);
+                    if (!bond.has_value()) {
+                        continue;
+                    }
 
-            auto bond = load_bond(isin);
-            if (!bond.has_value()) {
-                continue;
+                    std::lock_guard<std::mutex> lock(m);
+                    result.push_back(std::move(bond.value()));
+                } catch (...) {
+                    fail(std::current_exception());
+                    return;
+                }
             }
+        });
+    }
 
-            isins.insert(isin);
-            result.push_back(bond.value());
-        }
+    try {
+        producer([&](const std::string& isin) {
+            queued_isins.add(1);
+            if (!isin_queue.push(isin)) {
+                queued_isins.add(-1);
+                return false;
+            }
+            return true;
+        });
+    } catch (...) {
+        fail(std::current_exception());
     }
 
-    BOOST_LOG_TRIVIAL(debug) << "Total bonds loaded: " << std::to_string(result.size());
+    isin_queue.close();
+    bond_workers.clear();
+    in_progress.set(0);
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
 
     return result;
 }
 
 std::unordered_set<std::string> BondsLoader::find(const int page) {
     std::unordered_set<std::string> isin_set;
+    auto on_match = [&](std::string_view match) {
+        auto isin = std::string {match};
+        boost::to_upper(isin);
+        isin_set.insert(std::move(isin));
+    };
 
     auto path = std::vformat(config.rank.path_template, std::make_format_args(page));
-    auto response = sl_client.get(path);
-
-    std::sregex_iterator it(response.begin(), response.end(), rank_regex);
-    std::sregex_iterator end;
-
-    if (it == end) {
-        return isin_set;
-    }
-    
-    for (; it != end; it++) {
-        std::smatch match = *it;
-        if (match.size() < 2) {
-            continue;
-        }
-
-        isin_set.insert(boost::to_upper_copy<std::string>(match[1].str()));
-    }
+    auto scan = rank_matcher->scan();
+    sl_client.get(path, [&](std::string_view chunk) { scan.feed(chunk, on_match); });
+    scan.finish(on_match);
 
     return isin_set;
 }
 
 std::optional<BondInfo> BondsLoader::load_bond(const std::string& bond_isin) {
+    trace::Span span {"load_bond"};
     std::string metadata_response;
     time_point now = std::chrono::system_clock::now();
 
@@ -91,21 +238,29 @@ std::optional<BondInfo> BondsLoader::load_bond(const std::string& bond_isin) {
     }
 
     AccuredInterestRequest interest_request { .from = now, .to = now, .uid = metadata.uid };
-    auto interest_response = t_client.post(config.broker.interest_path, to_json(interest_request));
-    auto interest = parse<AccuredInterestResponse>(interest_response);
+    auto interest_response = t_client.async_post(config.broker.interest_path, to_json(interest_request));
 
     time_point coupon_start_date = now + std::chrono::days(1);
     time_point coupon_end_date = metadata.maturity_date + std::chrono::days(7);
     CouponsRequest coupons_request { .from = coupon_start_date, .to = coupon_end_date, .uid = metadata.uid };
-    auto coupons_response = t_client.post(config.broker.coupons_path, to_json(coupons_request));
-    auto coupons = parse<CouponsResponse>(coupons_response);
+    auto coupons_response = t_client.async_post(config.broker.coupons_path, to_json(coupons_request));
+
+    auto interest = parse<AccuredInterestResponse>(interest_response.get());
+    auto coupons = parse<CouponsResponse>(coupons_response.get());
 
     long cash_flow = metadata.nominal;
+    time_point next_coupon_date = time_point::max();
+    long next_coupon = interest.interest;
     for (auto& coupon : coupons.coupons) {
         if (coupon.date < coupon_start_date) {
             continue;
         }
         cash_flow += coupon.interest;
+
+        if (coupon.date < next_coupon_date) {
+            next_coupon_date = coupon.date;
+            next_coupon = coupon.interest;
+        }
     }
 
     time_point maturity_date;
@@ -140,7 +295,11 @@ std::optional<BondInfo> BondsLoader::load_bond(const std::string& bond_isin) {
             .accured_interest = interest.interest,
             .nominal = metadata.nominal,
             .cash_flow = cash_flow,
-            .dtm = dtm
+            .dtm = dtm,
+            .loaded = now,
+            .fetched = now,
+            .next_coupon_date = next_coupon_date,
+            .next_coupon = next_coupon
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef SECURITIES_SCANNER_LOADER_BOUNDED_QUEUE_H
+#define SECURITIES_SCANNER_LOADER_BOUNDED_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Blocking multi-producer/multi-consumer queue. Producers wait while the queue
+// is full, consumers wait while it is empty. Once closed, push() fails and pop()
+// drains the remaining items before returning an empty optional.
+template<typename T>
+class BoundedQueue {
+    public:
+        explicit BoundedQueue(const size_t a_capacity) : capacity {a_capacity}, closed {false} {}
+
+        BoundedQueue(const BoundedQueue& other) = delete;
+        BoundedQueue& operator=(const BoundedQueue& other) = delete;
+
+        bool push(T value) {
+            std::unique_lock<std::mutex> lock(m);
+            not_full.wait(lock, [&]() { return closed || items.size() < capacity; });
+            if (closed) {
+                return false;
+            }
+
+            items.push_back(std::move(value));
+            not_empty.notify_one();
+            return true;
+        }
+
+        std::optional<T> pop() {
+            std::unique_lock<std::mutex> lock(m);
+            not_empty.wait(lock, [&]() { return closed || !items.empty(); });
+            if (items.empty()) {
+                return {};
+            }
+
+            auto value = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return std::optional<T> {std::move(value)};
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(m);
+            closed = true;
+            not_full.notify_all();
+            not_empty.notify_all();
+        }
+
+        // Closes the queue and drops everything that has not been consumed yet.
+        void cancel() {
+            std::lock_guard<std::mutex> lock(m);
+            closed = true;
+            items.clear();
+            not_full.notify_all();
+            not_empty.notify_all();
+        }
+    private:
+        const size_t capacity;
+        bool closed;
+        std::deque<T> items;
+        std::mutex m;
+        std::condition_variable not_full;
+        std::condition_variable not_empty;
+};
+
+#endif // SECURITIES_SCANNER_LOADER_BOUNDED_QUEUE_H
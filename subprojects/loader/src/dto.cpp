@@ -1,8 +1,11 @@
 #include "dto.h"
+#include "json_reader.h"
+#include "uuid_codec.h"
 
 #include <boost/uuid/string_generator.hpp>
-#include <boost/uuid/uuid_io.hpp>
 #include "price_calc.h"
+#include <algorithm>
+#include <optional>
 
 void read_json_value(const std::string& json, Json::Value& out_value) {
     Json::Reader reader;
@@ -16,9 +19,59 @@ std::string write_json_value(const Json::Value& value) {
     return writer.write(value);
 }
 
-boost::uuids::uuid parse_uid(const std::string& uid) {
+boost::uuids::uuid parse_uid(std::string_view uid) {
+    boost::uuids::uuid result;
+    if (parse_uuid(uid, result)) {
+        return result;
+    }
+
     boost::uuids::string_generator gen;
-    return gen(uid);
+    return gen(uid.begin(), uid.end());
+}
+
+long read_quotation(JsonReader& reader) {
+    int64_t units = 0;
+    int64_t nano = 0;
+    std::string_view key;
+
+    reader.begin_object();
+    while (reader.next_member(key)) {
+        if (key == "units") {
+            units = reader.read_int();
+        } else if (key == "nano") {
+            nano = reader.read_int();
+        } else {
+            reader.skip_value();
+        }
+    }
+
+    return calc_price(units, nano);
+}
+
+long read_first_order_price(JsonReader& reader) {
+    long price = 0;
+    bool first = true;
+    std::string_view key;
+
+    reader.begin_array();
+    while (reader.next_element()) {
+        if (!first) {
+            reader.skip_value();
+            continue;
+        }
+        first = false;
+
+        reader.begin_object();
+        while (reader.next_member(key)) {
+            if (key == "price" && !reader.read_null()) {
+                price = read_quotation(reader);
+            } else {
+                reader.skip_value();
+            }
+        }
+    }
+
+    return price;
 }
 
 std::string date_iso_8601(const time_point& t) {
@@ -54,7 +107,7 @@ std::string to_json(const AccuredInterestRequest& request) {
     Json::Value root;
     root["from"] = date_iso_8601(request.from);
     root["to"] = date_iso_8601(request.to);
-    root["instrumentId"] = boost::uuids::to_string(request.uid);
+    root["instrumentId"] = format_uuid(request.uid);
 
     return write_json_value(root);
 }
@@ -64,26 +117,73 @@ std::string to_json(const CouponsRequest& request) {
     Json::Value root;
     root["from"] = date_iso_8601(request.from);
     root["to"] = date_iso_8601(request.to);
-    root["instrumentId"] = boost::uuids::to_string(request.uid);
+    root["instrumentId"] = format_uuid(request.uid);
 
     return write_json_value(root);
 }
 
 template<>
 std::string to_json(const PriceRequest& request) {
-    Json::Value root;
-    Json::Value uids(Json::arrayValue);
-    for (unsigned int i = 0; i < request.instrument_id.size(); i++) {
-        uids[i] = boost::uuids::to_string(request.instrument_id[i]);
+    constexpr std::string_view prefix = "{\"instrumentId\":[";
+    constexpr std::string_view suffix = "]}";
+
+    std::string json;
+    json.resize(prefix.size() + request.instrument_id.size() * (UUID_TEXT_SIZE + 3) + suffix.size());
+
+    char* out = json.data();
+    out = std::copy(prefix.begin(), prefix.end(), out);
+    for (size_t i = 0; i < request.instrument_id.size(); i++) {
+        if (i > 0) {
+            *out++ = ',';
+        }
+        *out++ = '"';
+        format_uuid(request.instrument_id[i], out);
+        out += UUID_TEXT_SIZE;
+        *out++ = '"';
     }
-    root["instrumentId"] = uids;
-    return write_json_value(root);
+    out = std::copy(suffix.begin(), suffix.end(), out);
+
+    json.resize(out - json.data());
+    return json;
+}
+
+template<>
+std::string to_json(const LastPriceSubscriptionRequest& request) {
+    constexpr std::string_view subscribe_prefix = 
+        "{\"subscribeLastPriceRequest\":{\"subscriptionAction\":\"SUBSCRIPTION_ACTION_SUBSCRIBE\",\"instruments\":[";
+    constexpr std::string_view unsubscribe_prefix = 
+        "{\"subscribeLastPriceRequest\":{\"subscriptionAction\":\"SUBSCRIPTION_ACTION_UNSUBSCRIBE\",\"instruments\":[";
+    constexpr std::string_view instrument_prefix = "{\"instrumentId\":\"";
+    constexpr std::string_view instrument_suffix = "\"}";
+    constexpr std::string_view suffix = "]}}";
+
+    auto prefix = request.subscribe ? subscribe_prefix : unsubscribe_prefix;
+    auto instrument_size = instrument_prefix.size() + UUID_TEXT_SIZE + instrument_suffix.size() + 1;
+
+    std::string json;
+    json.resize(prefix.size() + request.instrument_id.size() * instrument_size + suffix.size());
+
+    char* out = json.data();
+    out = std::copy(prefix.begin(), prefix.end(), out);
+    for (size_t i = 0; i < request.instrument_id.size(); i++) {
+        if (i > 0) {
+            *out++ = ',';
+        }
+        out = std::copy(instrument_prefix.begin(), instrument_prefix.end(), out);
+        format_uuid(request.instrument_id[i], out);
+        out += UUID_TEXT_SIZE;
+        out = std::copy(instrument_suffix.begin(), instrument_suffix.end(), out);
+    }
+    out = std::copy(suffix.begin(), suffix.end(), out);
+
+    json.resize(out - json.data());
+    return json;
 }
 
 template<>
 std::string to_json(const BookRequest& request) {
     Json::Value root;
-    root["instrumentId"] = boost::uuids::to_string(request.uid);
+    root["instrumentId"] = format_uuid(request.uid);
     root["depth"] = std::to_string(request.depth);
 
     return write_json_value(root);
@@ -157,49 +257,104 @@ CouponsResponse parse<CouponsResponse>(const std::string& json_str) {
     return CouponsResponse { .coupons = std::move(coupons) };
 }
 
-template<>
-PriceResponse parse<PriceResponse>(const std::string& json_str) {
-    Json::Value json;
-    read_json_value(json_str, json);
+template<typename F>
+void read_prices(std::string_view json, F&& on_price) {
+    JsonReader reader {json};
+    std::string_view key;
 
-    auto price_entries = std::vector<PriceResponseEntry> {};
-    auto response_entries = json["lastPrices"];
-    for (auto& response_entry : response_entries) {
-        auto uid = parse_uid(response_entry["instrumentUid"].asString());
-        if (!response_entry.isMember("price")) {
+    reader.begin_object();
+    while (reader.next_member(key)) {
+        if (key != "lastPrices") {
+            reader.skip_value();
             continue;
         }
-        auto price = response_entry["price"];
-        auto units = std::stoi(price["units"].asString());
-        auto nano = price["nano"].asInt64();
-        price_entries.push_back(PriceResponseEntry { uid, calc_price(units, nano) });
+
+        reader.begin_array();
+        while (reader.next_element()) {
+            std::string_view uid;
+            std::optional<long> price;
+
+            reader.begin_object();
+            while (reader.next_member(key)) {
+                if (key == "instrumentUid") {
+                    uid = reader.read_string();
+                } else if (key == "price" && !reader.read_null()) {
+                    price = read_quotation(reader);
+                } else {
+                    reader.skip_value();
+                }
+            }
+
+            if (!uid.empty() && price.has_value()) {
+                on_price(parse_uid(uid), price.value());
+            }
+        }
     }
+}
 
-    return PriceResponse { .last_prices = std::move(price_entries) };
+void parse_prices(std::string_view json, PriceMap& prices) {
+    read_prices(json, [&](const boost::uuids::uuid& uid, long price) {
+        prices[uid] = price;
+    });
 }
 
-template<>
-BookResponse parse<BookResponse>(const std::string& json_str) {
-    Json::Value json;
-    read_json_value(json_str, json);
+void parse_prices(std::string_view json, const InstrumentIds& ids, PricePoints& prices) {
+    read_prices(json, [&](const boost::uuids::uuid& uid, long price) {
+        auto id = ids.find(uid);
+        if (id != InstrumentIds::NONE) {
+            prices.push_back(PricePoint { .id = id, .price = price });
+        }
+    });
+}
 
-    auto bids = json["bids"];
-    long bid = 0;
-    if (bids.size() != 0) {
-        auto price = bids[0]["price"];
-        auto units = std::stoi(price["units"].asString());
-        auto nano = price["nano"].asInt64();
-        bid = calc_price(units, nano);
+void parse_last_price(std::string_view json, PriceMap& prices) {
+    JsonReader reader {json};
+    std::string_view key;
+
+    reader.begin_object();
+    while (reader.next_member(key)) {
+        if (key != "lastPrice") {
+            reader.skip_value();
+            continue;
+        }
+
+        std::string_view uid;
+        std::optional<long> price;
+
+        reader.begin_object();
+        while (reader.next_member(key)) {
+            if (key == "instrumentUid") {
+                uid = reader.read_string();
+            } else if (key == "price" && !reader.read_null()) {
+                price = read_quotation(reader);
+            } else {
+                reader.skip_value();
+            }
+        }
+
+        if (!uid.empty() && price.has_value()) {
+            prices[parse_uid(uid)] = price.value();
+        }
     }
+}
 
-    auto asks = json["asks"];
+template<>
+BookResponse parse<BookResponse>(const std::string& json_str) {
+    JsonReader reader {json_str};
+    std::string_view key;
+    long bid = 0;
     long ask = 0;
-    if (bids.size() != 0) {
-        auto price = asks[0]["price"];
-        auto units = std::stoi(price["units"].asString());
-        auto nano = price["nano"].asInt64();
-        ask = calc_price(units, nano);
+
+    reader.begin_object();
+    while (reader.next_member(key)) {
+        if (key == "bids") {
+            bid = read_first_order_price(reader);
+        } else if (key == "asks") {
+            ask = read_first_order_price(reader);
+        } else {
+            reader.skip_value();
+        }
     }
 
     return BookResponse { .bid_price = bid, .ask_price = ask };
-}
\ No newline at end of file
+}
@@ -1,9 +1,11 @@
 #ifndef SECURITIES_SCANNER_LOADER_DTO_H
 #define SECURITIES_SCANNER_LOADER_DTO_H
 
+#include <sscan/price_loader.h>
 #include <boost/uuid/uuid.hpp>
 #include <chrono>
 #include <string>
+#include <string_view>
 #include <json/json.h>
 #include <vector>
 
@@ -49,13 +51,9 @@ struct PriceRequest {
     std::vector<boost::uuids::uuid> instrument_id;
 };
 
-struct PriceResponseEntry {
-    boost::uuids::uuid instrument_id;
-    long price;
-};
-
-struct PriceResponse {
-    std::vector<PriceResponseEntry> last_prices;
+struct LastPriceSubscriptionRequest {
+    bool subscribe;
+    std::vector<boost::uuids::uuid> instrument_id;
 };
 
 struct Coupon {
@@ -83,4 +81,12 @@ std::string to_json(const T& value);
 template <typename T>
 T parse(const std::string& json);
 
+// Canonical uids take the fast path, other spellings go through boost
+boost::uuids::uuid parse_uid(std::string_view uid);
+
+void parse_prices(std::string_view json, PriceMap& prices);
+// Prices of instruments outside ids are dropped
+void parse_prices(std::string_view json, const InstrumentIds& ids, PricePoints& prices);
+void parse_last_price(std::string_view json, PriceMap& prices);
+
 #endif // SECURITIES_SCANNER_LOADER_DTO_H
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include <sscan/http.h>
+#include <sscan/metrics.h>
+#include <sscan/trace.h>
 
-#include <iostream>
+#include <algorithm>
+#include <cctype>
+#include <deque>
+#include <mutex>
+#include <json/json.h>
+#include <optional>
 #include <stdexcept>
 #include <boost/beast/core/stream_traits.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/log/trivial.hpp>
 
 namespace beast = boost::beast;
 namespace asio = boost::asio;
@@ -11,13 +20,493 @@ namespace ip = asio::ip;
 
 using namespace http;
 
+using stream_t = beast::ssl_stream<beast::tcp_stream>;
+
 const int HTTP_CLIENT_MAX_ATTEMPTS = 3;
+const int HTTP_CLIENT_IO_THREADS = 2;
+const auto HTTP_CLIENT_TIMEOUT = std::chrono::seconds(30);
+
+IoContext::IoContext(const int a_threads) :
+    io {},
+    ssl {ssl::context::tls_client},
+    work {asio::make_work_guard(io)},
+    threads {} {
+
+    for (int i = 0; i < a_threads; i++) {
+        threads.emplace_back([this]() {
+            while (true) {
+                try {
+                    io.run();
+                    return;
+                } catch (const std::exception& ex) {
+                    BOOST_LOG_TRIVIAL(error) << "Error in http handler: " << ex.what();
+                }
+            }
+        });
+    }
+}
+
+IoContext::~IoContext() {
+    work.reset();
+    io.stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+asio::io_context& IoContext::get_io() {
+    return io;
+}
+
+ssl::context& IoContext::get_ssl() {
+    return ssl;
+}
+
+std::shared_ptr<IoContext> IoContext::shared() {
+    static auto context = std::make_shared<IoContext>(HTTP_CLIENT_IO_THREADS);
+    return context;
+}
+
+namespace {
+
+    struct Connection {
+        stream_t stream;
+        beast::flat_buffer buffer;
+        bool connected;
+
+        Connection(IoContext& context) :
+            stream {asio::make_strand(context.get_io()), context.get_ssl()},
+            buffer {},
+            connected {false} {}
+
+        void close() {
+            beast::error_code ec;
+            beast::get_lowest_layer(stream).socket().close(ec);
+        }
+    };
+
+}
+
+// Per-host set of keep-alive connections. A request takes an idle connection,
+// opens a new one while below max_connections, or waits for one to be released.
+class HttpClient::Pool : public std::enable_shared_from_this<HttpClient::Pool> {
+    public:
+        using ConnectionHandler = std::function<void (std::unique_ptr<Connection>)>;
+
+        // host may carry a port for local stand-ins, the default is 443
+        const std::string host;
+        const std::string hostname;
+        const std::string port;
+        const std::string auth;
+        const std::shared_ptr<IoContext> context;
+
+        Pool(const std::string& a_host, const std::string& a_auth, const int a_max_connections) :
+            host {a_host},
+            hostname {a_host.substr(0, a_host.rfind(':'))},
+            port {a_host.rfind(':') == std::string::npos ? "443" : a_host.substr(a_host.rfind(':') + 1)},
+            auth {a_auth},
+            context {IoContext::shared()},
+            max_connections {static_cast<size_t>(std::max(a_max_connections, 1))},
+            open_connections {0},
+            idle {},
+            waiters {} {}
+
+        void acquire(ConnectionHandler handler) {
+            std::unique_lock<std::mutex> lock(m);
+            if (!idle.empty()) {
+                auto connection = std::move(idle.back());
+                idle.pop_back();
+                lock.unlock();
+                handler(std::move(connection));
+                return;
+            }
+
+            if (open_connections < max_connections) {
+                open_connections++;
+                lock.unlock();
+                handler(std::make_unique<Connection>(*context));
+                return;
+            }
+
+            waiters.push_back(std::move(handler));
+        }
+
+        void release(std::unique_ptr<Connection> connection) {
+            std::unique_lock<std::mutex> lock(m);
+            if (waiters.empty()) {
+                idle.push_back(std::move(connection));
+                return;
+            }
+
+            auto handler = std::move(waiters.front());
+            waiters.pop_front();
+            lock.unlock();
+            handler(std::move(connection));
+        }
+
+        void discard(std::unique_ptr<Connection> connection) {
+            connection->close();
+            connection.reset();
+
+            std::unique_lock<std::mutex> lock(m);
+            if (waiters.empty()) {
+                open_connections--;
+                return;
+            }
+
+            auto handler = std::move(waiters.front());
+            waiters.pop_front();
+            lock.unlock();
+            handler(std::make_unique<Connection>(*context));
+        }
+
+        void close_idle() {
+            std::vector<std::unique_ptr<Connection>> closing;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                closing.swap(idle);
+                open_connections -= closing.size();
+            }
+
+            for (auto& connection : closing) {
+                connection->close();
+            }
+        }
+    private:
+        const size_t max_connections;
+        std::mutex m;
+        size_t open_connections;
+        std::vector<std::unique_ptr<Connection>> idle;
+        std::deque<ConnectionHandler> waiters;
+};
+
+namespace {
+
+    // Request path without the query, with numeric segments collapsed so that
+    // the endpoint label stays bounded
+    std::string endpoint_label(std::string_view target) {
+        auto path = target.substr(0, target.find('?'));
+        auto label = std::string();
+        label.reserve(path.size());
+
+        size_t begin = 0;
+        while (begin < path.size()) {
+            auto end = path.find('/', begin + 1);
+            if (end == std::string_view::npos) {
+                end = path.size();
+            }
+
+            auto segment = path.substr(begin, end - begin);
+            auto digits = segment.substr(segment.starts_with('/') ? 1 : 0);
+            if (!digits.empty() && std::all_of(digits.begin(), digits.end(), [](char c) { return std::isdigit(c); })) {
+                label.append("/:n");
+            } else {
+                label.append(segment);
+            }
+            begin = end;
+        }
+
+        return label;
+    }
+
+    metrics::Family<metrics::Histogram>& request_seconds() {
+        static auto& family = metrics::Registry::shared().histogram(
+            "sscan_http_request_seconds", "Broker HTTP requests by endpoint and status", {"host", "endpoint", "status"});
+        return family;
+    }
+
+    metrics::Family<metrics::Counter>& retries_total() {
+        static auto& family = metrics::Registry::shared().counter(
+            "sscan_http_retries_total", "Broker HTTP requests retried on a new connection", {"host"});
+        return family;
+    }
+
+    using request_t = beast::http::request<beast::http::string_body>;
+    using response_t = beast::http::response<beast::http::string_body>;
+    using parser_t = beast::http::response_parser<beast::http::string_body>;
+
+    // A single request travelling through the pool: connect if needed, write, read
+    // and retry on a new connection when the exchange fails. With a chunk handler
+    // the body is handed out as it is parsed, and a failure after the first chunk
+    // is not retried.
+    template<typename Pool>
+    class Call : public std::enable_shared_from_this<Call<Pool>> {
+        public:
+            Call(std::shared_ptr<Pool> a_pool, request_t a_request, ResponseHandler a_handler, ChunkHandler a_on_chunk) :
+                pool {std::move(a_pool)},
+                request {std::move(a_request)},
+                handler {std::move(a_handler)},
+                on_chunk {std::move(a_on_chunk)},
+                attempt {1},
+                reused {false},
+                delivered {false},
+                recorder {Recorder::shared()},
+                recorded {} {}
+
+            void start() {
+                if (!started.has_value()) {
+                    started = std::chrono::steady_clock::now();
+                }
+
+                pool->acquire([self = this->shared_from_this()](std::unique_ptr<Connection> connection) {
+                    self->on_connection(std::move(connection));
+                });
+            }
+        private:
+            std::shared_ptr<Pool> pool;
+            request_t request;
+            response_t response;
+            std::optional<parser_t> parser;
+            ResponseHandler handler;
+            ChunkHandler on_chunk;
+            int attempt;
+            bool reused;
+            bool delivered;
+            std::unique_ptr<Connection> connection;
+            std::optional<ip::tcp::resolver> resolver;
+            std::optional<std::chrono::steady_clock::time_point> started;
+            std::shared_ptr<Recorder> recorder;
+            std::string recorded;
+
+            void observe(const std::string& status) {
+                trace::record("http", "http", started.value(), std::chrono::steady_clock::now());
+                auto endpoint = endpoint_label(std::string_view {request.target()});
+                request_seconds().with({pool->host, endpoint, status})
+                    .observe(std::chrono::steady_clock::now() - started.value());
+            }
+
+            void on_connection(std::unique_ptr<Connection> a_connection) {
+                connection = std::move(a_connection);
+                reused = connection->connected;
+                if (reused) {
+                    write();
+                } else {
+                    connect();
+                }
+            }
+
+            void connect() {
+                if (!SSL_set_tlsext_host_name(connection->stream.native_handle(), pool->hostname.c_str())) {
+                    fail(beast::error_code {static_cast<int>(::ERR_get_error()), asio::error::get_ssl_category()});
+                    return;
+                }
+
+                resolver.emplace(connection->stream.get_executor());
+                resolver->async_resolve(pool->hostname, pool->port,
+                    [self = this->shared_from_this()](beast::error_code ec, ip::tcp::resolver::results_type results) {
+                        if (ec) {
+                            self->fail(ec);
+                            return;
+                        }
+
+                        auto& tcp_stream = beast::get_lowest_layer(self->connection->stream);
+                        tcp_stream.expires_after(HTTP_CLIENT_TIMEOUT);
+                        tcp_stream.async_connect(results, [self](beast::error_code ec, ip::tcp::endpoint) {
+                            if (ec) {
+                                self->fail(ec);
+                                return;
+                            }
+
+                            self->connection->stream.async_handshake(ssl::stream_base::client, [self](beast::error_code ec) {
+                                if (ec) {
+                                    self->fail(ec);
+                                    return;
+                                }
+
+                                self->connection->connected = true;
+                                self->write();
+                            });
+                        });
+                    });
+            }
+
+            void write() {
+                beast::get_lowest_layer(connection->stream).expires_after(HTTP_CLIENT_TIMEOUT);
+                beast::http::async_write(connection->stream, request,
+                    [self = this->shared_from_this()](beast::error_code ec, size_t) {
+                        if (ec) {
+                            self->fail(ec);
+                            return;
+                        }
+
+                        if (self->on_chunk) {
+                            self->parser.emplace();
+                            self->read_chunk();
+                        } else {
+                            self->read();
+                        }
+                    });
+            }
+
+            void read_chunk() {
+                beast::http::async_read_some(connection->stream, connection->buffer, *parser,
+                    [self = this->shared_from_this()](beast::error_code ec, size_t) {
+                        if (ec) {
+                            self->fail(ec);
+                            return;
+                        }
+
+                        try {
+                            self->deliver();
+                        } catch (...) {
+                            self->pool->discard(std::move(self->connection));
+                            self->observe("error");
+                            self->handler(std::current_exception(), {});
+                            return;
+                        }
+
+                        if (!self->parser->is_done()) {
+                            self->read_chunk();
+                            return;
+                        }
+
+                        self->response = self->parser->release();
+                        self->complete();
+                    });
+            }
+
+            void deliver() {
+                if (!parser->is_header_done() || parser->get().result() != beast::http::status::ok) {
+                    return;
+                }
+
+                auto& body = parser->get().body();
+                if (body.empty()) {
+                    return;
+                }
+
+                if (recorder) {
+                    recorded.append(body);
+                }
+                delivered = true;
+                on_chunk(body);
+                body.clear();
+            }
+
+            void read() {
+                response = {};
+                beast::http::async_read(connection->stream, connection->buffer, response,
+                    [self = this->shared_from_this()](beast::error_code ec, size_t) {
+                        if (ec) {
+                            self->fail(ec);
+                            return;
+                        }
+
+                        self->complete();
+                    });
+            }
+
+            void complete() {
+                if (response.keep_alive()) {
+                    pool->release(std::move(connection));
+                } else {
+                    pool->discard(std::move(connection));
+                }
+                observe(std::to_string(response.result_int()));
+
+                if (recorder) {
+                    recorder->record(Exchange {
+                        .host = pool->host,
+                        .method = std::string {request.method_string()},
+                        .target = std::string {request.target()},
+                        .request = request.body(),
+                        .status = response.result_int(),
+                        .response = on_chunk ? std::move(recorded) : response.body()
+                    });
+                }
+
+                switch (response.result()) {
+                    case beast::http::status::ok:
+                        handler(nullptr, std::move(response.body()));
+                        return;
+                    case beast::http::status::not_found:
+                        handler(std::make_exception_ptr(not_found()), {});
+                        return;
+                    default:
+                        handler(
+                            std::make_exception_ptr(std::runtime_error {"HTTP status: " + std::to_string(response.result_int())}),
+                            {});
+                        return;
+                }
+            }
+
+            void fail(beast::error_code ec) {
+                BOOST_LOG_TRIVIAL(warning) << "HTTP error: " << pool->host << " " << ec.message();
+                pool->discard(std::move(connection));
+
+                // A keep-alive connection may have been closed by the server while idle,
+                // so only failures on freshly opened connections count as attempts.
+                if (!reused) {
+                    attempt++;
+                }
 
-HttpClient::HttpClient(const std::string& a_host) 
-    : host {a_host}, auth {}, rate_limiter {} {}
+                if (attempt > HTTP_CLIENT_MAX_ATTEMPTS || delivered) {
+                    observe("error");
+                    handler(std::make_exception_ptr(beast::system_error {ec}), {});
+                    return;
+                }
+
+                retries_total().with({pool->host}).inc();
+                start();
+            }
+    };
+
+}
+
+namespace {
+
+    std::mutex recorder_m;
+    std::shared_ptr<Recorder> shared_recorder;
+
+}
+
+Recorder::Recorder(const std::string& path) : out {path, std::ios::app} {
+    if (!out) {
+        throw std::runtime_error {"Unable to open " + path};
+    }
+}
+
+void Recorder::record(const Exchange& exchange) {
+    Json::Value line;
+    line["host"] = exchange.host;
+    line["method"] = exchange.method;
+    line["target"] = exchange.target;
+    line["request"] = exchange.request;
+    line["status"] = exchange.status;
+    line["response"] = exchange.response;
+
+    Json::FastWriter writer;
+    auto text = writer.write(line);
+
+    std::lock_guard<std::mutex> lock(m);
+    out << text;
+    out.flush();
+}
+
+std::shared_ptr<Recorder> Recorder::shared() {
+    std::lock_guard<std::mutex> lock(recorder_m);
+    return shared_recorder;
+}
+
+void Recorder::set_shared(std::shared_ptr<Recorder> recorder) {
+    std::lock_guard<std::mutex> lock(recorder_m);
+    shared_recorder = std::move(recorder);
+}
 
-HttpClient::HttpClient(const std::string& a_host, const std::string& a_auth, const int rps) 
-    : host {a_host}, auth {a_auth}, rate_limiter {RateLimiter(rps)} {}
+HttpClient::HttpClient(const std::string& a_host, const int max_connections)
+    : rate_limiter {}, pool {std::make_shared<Pool>(a_host, std::string {}, max_connections)} {}
+
+HttpClient::HttpClient(const std::string& a_host, const std::string& a_auth, const int rps, const int max_connections)
+    : rate_limiter {std::make_shared<RateLimiter>(rps, 1, a_host)},
+    pool {std::make_shared<Pool>(a_host, a_auth, max_connections)} {}
+
+HttpClient::HttpClient(
+    const std::string& a_host,
+    const std::string& a_auth,
+    std::shared_ptr<RateLimiter> a_rate_limiter,
+    const int max_connections)
+    : rate_limiter {std::move(a_rate_limiter)},
+    pool {std::make_shared<Pool>(a_host, a_auth, max_connections)} {}
 
 HttpClient::~HttpClient() {
     try {
@@ -28,94 +517,86 @@ HttpClient::~HttpClient() {
 }
 
 std::string HttpClient::get(const std::string& path) {
-    return this->request(beast::http::verb::get, path, {});
+    return this->request(beast::http::verb::get, path, {}).get();
+}
+
+void HttpClient::get(const std::string& path, ChunkHandler on_chunk) {
+    this->request(beast::http::verb::get, path, {}, std::move(on_chunk)).get();
 }
 
 std::string HttpClient::post(const std::string& path, const std::string& request) {
+    return this->request(beast::http::verb::post, path, request).get();
+}
+
+std::future<std::string> HttpClient::async_get(const std::string& path) {
+    return this->request(beast::http::verb::get, path, {});
+}
+
+std::future<std::string> HttpClient::async_post(const std::string& path, const std::string& request) {
     return this->request(beast::http::verb::post, path, request);
 }
 
-std::string HttpClient::request(beast::http::verb method, const std::string& path, const std::string& request) {
-    if (rate_limiter.has_value()) {
-        rate_limiter.value().acquire();
-    }
+void HttpClient::async_get(const std::string& path, ResponseHandler handler) {
+    this->request(beast::http::verb::get, path, {}, std::move(handler));
+}
 
-    if (!ssl_socket_stream.get()) {
-        connect();
-    }
+void HttpClient::async_post(const std::string& path, const std::string& request, ResponseHandler handler) {
+    this->request(beast::http::verb::post, path, request, std::move(handler));
+}
+
+std::future<std::string> HttpClient::request(
+    beast::http::verb method,
+    const std::string& path,
+    const std::string& request,
+    ChunkHandler on_chunk) {
 
-    beast::http::request<beast::http::string_body> req{ method, path, 11 };
-    req.set(beast::http::field::host, host);
+    auto promise = std::make_shared<std::promise<std::string>>();
+    auto future = promise->get_future();
+
+    this->request(method, path, request, [promise](std::exception_ptr error, std::string body) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(body));
+        }
+    }, std::move(on_chunk));
+
+    return future;
+}
+
+void HttpClient::request(
+    beast::http::verb method,
+    const std::string& path,
+    const std::string& request,
+    ResponseHandler handler,
+    ChunkHandler on_chunk) {
+
+    request_t req{ method, path, 11 };
+    req.set(beast::http::field::host, pool->host);
     req.set(boost::beast::http::field::content_type, "application/json");
     req.set(boost::beast::http::field::user_agent, "Chrome/146.0.0.0");
     req.set(boost::beast::http::field::accept, "*/*");
     req.set(boost::beast::http::field::accept_encoding, "identity");
 
-    if (auth.length() > 0) {
-        req.set(beast::http::field::authorization, auth);
+    if (pool->auth.length() > 0) {
+        req.set(beast::http::field::authorization, pool->auth);
     }
     req.body() = std::string {request};
     req.prepare_payload();
 
-   beast:: http::response<beast::http::string_body> res;
-
-    for (int attempt = 1; attempt <= HTTP_CLIENT_MAX_ATTEMPTS; attempt++) {
-        try {
-            beast::http::response<beast::http::string_body> current_res;
-            beast::flat_buffer buffer;
-            beast::http::write(*ssl_socket_stream, req);
-            beast::http::read(*ssl_socket_stream, buffer, current_res);
-            res = std::move(current_res);
-            break;
-        } catch (std::exception const& e) {
-            std::cerr << "Error: " << e.what() << std::endl;
-
-            if (attempt >= HTTP_CLIENT_MAX_ATTEMPTS) {
-                throw e;
-            }
-
-            shutdown();
-            connect();
-        }
-    }
-
-    switch (res.result())
-    {
-        case beast::http::status::ok:
-            return res.body();
-        case beast::http::status::not_found:
-            throw not_found();
-        default:
-            throw std::runtime_error {"HTTP status: " + std::to_string(res.result_int())};
+    auto call = std::make_shared<Call<Pool>>(pool, std::move(req), std::move(handler), std::move(on_chunk));
+    if (!rate_limiter) {
+        call->start();
+        return;
     }
-}
-
-
-void HttpClient::connect() {
-    service = std::make_unique<asio::io_service>();
-    ssl::context ctx(asio::ssl::context::tls_client);
-
-    ssl_socket_stream = std::make_unique<socket_stream_t>(socket_stream_t { *service, ctx });
-    SSL_set_tlsext_host_name(ssl_socket_stream->native_handle(), host.c_str());
 
-    ip::tcp::resolver resolver(*service);
-    auto it = resolver.resolve(host, "443");
-    asio::connect(ssl_socket_stream->lowest_layer(), it);
-    ssl_socket_stream->handshake(ssl::stream_base::handshake_type::client);
+    rate_limiter->async_acquire(pool->context->get_io(), [call]() { call->start(); });
 }
 
 void HttpClient::shutdown() {
-    if (!ssl_socket_stream.get()) {
+    if (!pool) {
         return;
     }
 
-    try {
-        beast::close_socket(ssl_socket_stream->lowest_layer());
-        service->stop();
-    } catch (std::exception const& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-    }
-
-    ssl_socket_stream.reset();
-    service.reset();
-}
\ No newline at end of file
+    pool->close_idle();
+}
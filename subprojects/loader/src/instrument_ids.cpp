@@ -0,0 +1,54 @@
+#include <sscan/instrument_ids.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+InstrumentIds::InstrumentIds() :
+    uids {},
+    slots(1, NONE),
+    mask {0} {}
+
+// Open addressing with linear probing, at most half full
+InstrumentIds::InstrumentIds(std::vector<boost::uuids::uuid> a_uids) :
+    uids {std::move(a_uids)},
+    slots(std::bit_ceil(std::max<size_t>(uids.size() * 2, 2)), NONE),
+    mask {slots.size() - 1} {
+
+    if (uids.size() >= NONE) {
+        throw std::length_error {"Too many instruments to intern"};
+    }
+
+    for (u_int32_t id = 0; id < uids.size(); id++) {
+        auto slot = slot_of(uids[id]);
+        while (slots[slot] != NONE) {
+            if (uids[slots[slot]] == uids[id]) {
+                throw std::invalid_argument {"Duplicate instrument uid"};
+            }
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = id;
+    }
+}
+
+u_int32_t InstrumentIds::find(const boost::uuids::uuid& uid) const {
+    auto slot = slot_of(uid);
+    while (true) {
+        auto id = slots[slot];
+        if (id == NONE || uids[id] == uid) {
+            return id;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+// Broker uids are random, so folding the halves with one multiply spreads them well
+size_t InstrumentIds::slot_of(const boost::uuids::uuid& uid) const {
+    u_int64_t low;
+    u_int64_t high;
+    std::memcpy(&low, uid.data, sizeof(low));
+    std::memcpy(&high, uid.data + sizeof(low), sizeof(high));
+    auto hash = (low ^ high) * 0x9e3779b97f4a7c15ULL;
+    return (hash ^ (hash >> 32)) & mask;
+}
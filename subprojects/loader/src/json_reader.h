@@ -0,0 +1,162 @@
+#ifndef SECURITIES_SCANNER_LOADER_JSON_READER_H
+#define SECURITIES_SCANNER_LOADER_JSON_READER_H
+
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Forward-only pull parser over a JSON document held in memory. Values are read
+// in place: strings are returned as views into the input without unescaping,
+// which is enough for the identifiers and numbers in broker responses.
+class JsonReader {
+    public:
+        explicit JsonReader(std::string_view a_input) : input {a_input}, pos {0} {}
+
+        void begin_object() {
+            expect('{');
+        }
+
+        // Advances to the next member of the current object. Returns false and
+        // consumes the closing brace when there are no members left.
+        bool next_member(std::string_view& key) {
+            skip_whitespace();
+            if (peek() == '}') {
+                pos++;
+                return false;
+            }
+            if (peek() == ',') {
+                pos++;
+            }
+
+            key = read_string();
+            expect(':');
+            return true;
+        }
+
+        void begin_array() {
+            expect('[');
+        }
+
+        bool next_element() {
+            skip_whitespace();
+            if (peek() == ']') {
+                pos++;
+                return false;
+            }
+            if (peek() == ',') {
+                pos++;
+            }
+            return true;
+        }
+
+        bool read_null() {
+            skip_whitespace();
+            if (input.substr(pos, 4) != "null") {
+                return false;
+            }
+            pos += 4;
+            return true;
+        }
+
+        std::string_view read_string() {
+            expect('"');
+            auto start = pos;
+            while (pos < input.size() && input[pos] != '"') {
+                pos += input[pos] == '\\' ? 2 : 1;
+            }
+            if (pos >= input.size()) {
+                fail();
+            }
+            return input.substr(start, pos++ - start);
+        }
+
+        // Reads an integer written either as a number or as a quoted string,
+        // the way the broker encodes int64 fields.
+        int64_t read_int() {
+            skip_whitespace();
+            bool quoted = peek() == '"';
+            if (quoted) {
+                pos++;
+            }
+
+            int64_t value = 0;
+            auto [end, ec] = std::from_chars(input.data() + pos, input.data() + input.size(), value);
+            if (ec != std::errc {}) {
+                fail();
+            }
+            pos = end - input.data();
+
+            if (quoted) {
+                expect('"');
+            }
+            return value;
+        }
+
+        void skip_value() {
+            skip_whitespace();
+            switch (peek()) {
+                case '"':
+                    read_string();
+                    return;
+                case '{':
+                case '[': {
+                    int depth = 0;
+                    do {
+                        switch (peek()) {
+                            case '"':
+                                read_string();
+                                continue;
+                            case '{':
+                            case '[':
+                                depth++;
+                                break;
+                            case '}':
+                            case ']':
+                                depth--;
+                                break;
+                        }
+                        pos++;
+                    } while (depth > 0);
+                    return;
+                }
+                default:
+                    while (pos < input.size() && input[pos] != ',' && input[pos] != '}' && input[pos] != ']') {
+                        pos++;
+                    }
+                    return;
+            }
+        }
+    private:
+        std::string_view input;
+        size_t pos;
+
+        char peek() {
+            if (pos >= input.size()) {
+                fail();
+            }
+            return input[pos];
+        }
+
+        void expect(const char c) {
+            skip_whitespace();
+            if (peek() != c) {
+                fail();
+            }
+            pos++;
+        }
+
+        void skip_whitespace() {
+            while (pos < input.size() && 
+                (input[pos] == ' ' || input[pos] == '\n' || input[pos] == '\r' || input[pos] == '\t')) {
+                pos++;
+            }
+        }
+
+        [[noreturn]] void fail() {
+            throw std::invalid_argument { "Unable to parse json at " + std::to_string(pos) };
+        }
+};
+
+#endif // SECURITIES_SCANNER_LOADER_JSON_READER_H
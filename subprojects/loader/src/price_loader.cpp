@@ -1,27 +1,244 @@
 #include <sscan/price_loader.h>
 #include "dto.h"
+#include "bounded_queue.h"
+#include "price_stream.h"
+
+#include <sscan/metrics.h>
+#include <sscan/trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <boost/log/trivial.hpp>
+
+template<typename Prices>
+struct PriceBatch {
+    Prices prices;
+    std::exception_ptr error;
+};
+
+struct PriceLoader::BookFetch {
+    std::vector<boost::uuids::uuid> uids;
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<std::optional<long>> asks;
+    size_t next;
+    size_t completed;
+    bool expired;
+};
 
 PriceLoader::PriceLoader(const Config& a_config) 
     : config { a_config },
-     client { http::HttpClient{config.broker.host, config.broker.auth, config.broker.price_rps}} {}
+     client { http::HttpClient{
+        config.broker.host, 
+        config.broker.auth, 
+        http::RateLimiter::shared(config.broker.host + "/price", config.broker.price_rps, config.broker.price_burst),
+        config.broker.price_connections}},
+    stream { config.broker.price_stream_path.empty() 
+        ? nullptr
+        : std::make_shared<PriceStream>(
+            config.broker.price_stream_host,
+            config.broker.price_stream_port,
+            config.broker.price_stream_path,
+            config.broker.auth,
+            config.broker.price_batch_size) } {}
+
+PriceLoader::~PriceLoader() {
+    if (stream) {
+        stream->stop();
+    }
+}
+
+void PriceLoader::load(const InstrumentIds& ids, const std::vector<u_int32_t>& id, const PricePointHandler& handler) {
+    auto uid = std::vector<boost::uuids::uuid>();
+    uid.reserve(id.size());
+    for (auto instrument : id) {
+        uid.push_back(ids.uid(instrument));
+    }
+
+    // Blocks until every response is in, even when the handler throws, so the
+    // callbacks never outlive ids
+    load_batches<PricePoints>(uid,
+        [&ids](std::string_view json, PricePoints& prices) { parse_prices(json, ids, prices); },
+        handler);
+}
+
+template<typename Prices>
+void PriceLoader::load_batches(
+    const std::vector<boost::uuids::uuid>& uid,
+    const std::function<void (std::string_view json, Prices& prices)>& parse,
+    const std::function<void (Prices&& prices)>& handler) {
 
-PriceMap PriceLoader::load(const std::vector<boost::uuids::uuid>& uid) {
-    auto request = PriceRequest { .instrument_id = uid };
-    auto response = client.post(config.broker.price_path, to_json(request));
-    auto prices = parse<PriceResponse>(response);
+    auto batch_size = static_cast<size_t>(std::max(config.broker.price_batch_size, 1));
+    auto batches = (uid.size() + batch_size - 1) / batch_size;
+    auto results = std::make_shared<BoundedQueue<PriceBatch<Prices>>>(std::max<size_t>(batches, 1));
 
-    auto result = PriceMap();
-    result.reserve(prices.last_prices.size());
-    for (auto& price : prices.last_prices) {
-        result[price.instrument_id] = price.price;
+    for (size_t offset = 0; offset < uid.size(); offset += batch_size) {
+        auto last = std::min(offset + batch_size, uid.size());
+        auto batch_uids = last - offset;
+        auto body = std::string();
+        {
+            trace::Span span {"serialize_prices"};
+            auto request = PriceRequest { .instrument_id = {uid.begin() + offset, uid.begin() + last} };
+            body = to_json(request);
+        }
+
+        client.async_post(config.broker.price_path, body, 
+            [results, batch_uids, parse](std::exception_ptr error, std::string response) {
+                if (error) {
+                    results->push(PriceBatch<Prices> { .prices = {}, .error = error });
+                    return;
+                }
+
+                try {
+                    trace::Span span {"parse_prices"};
+                    auto batch = Prices();
+                    batch.reserve(batch_uids);
+                    parse(response, batch);
+                    results->push(PriceBatch<Prices> { .prices = std::move(batch), .error = nullptr });
+                } catch (...) {
+                    results->push(PriceBatch<Prices> { .prices = {}, .error = std::current_exception() });
+                }
+            });
+    }
+
+    // After a handler error the rest of the batches are only drained
+    std::exception_ptr error;
+    std::exception_ptr handler_error;
+    for (size_t i = 0; i < batches; i++) {
+        auto batch = results->pop();
+        if (batch->error) {
+            error = batch->error;
+            continue;
+        }
+        if (handler_error) {
+            continue;
+        }
+
+        try {
+            handler(std::move(batch->prices));
+        } catch (...) {
+            handler_error = std::current_exception();
+        }
     }
 
-    return result;
+    if (handler_error) {
+        std::rethrow_exception(handler_error);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
 }
 
-long PriceLoader::load_book_price(const boost::uuids::uuid& uid) {
-    auto request = BookRequest { .uid = uid, .depth = 1 };
-    auto response = client.post(config.broker.book_price_path, to_json(request));
-    auto book_price = parse<BookResponse>(response);
-    return book_price.ask_price;
-}
\ No newline at end of file
+std::vector<long> PriceLoader::load_book_prices(const InstrumentIds& ids, const std::vector<u_int32_t>& id) {
+    auto prices = std::vector<long>(id.size(), 0);
+    if (id.empty()) {
+        return prices;
+    }
+
+    auto uid = std::vector<boost::uuids::uuid>();
+    uid.reserve(id.size());
+    for (auto instrument : id) {
+        uid.push_back(ids.uid(instrument));
+    }
+
+    auto fetch = fetch_book_prices(std::move(uid));
+    std::lock_guard<std::mutex> lock(fetch->m);
+    for (size_t i = 0; i < prices.size(); i++) {
+        prices[i] = fetch->asks[i].value_or(0);
+    }
+    return prices;
+}
+
+// Waits for all book prices or the timeout. Late responses still land in the
+// fetch, so results are read under its lock.
+std::shared_ptr<PriceLoader::BookFetch> PriceLoader::fetch_book_prices(std::vector<boost::uuids::uuid> uid) {
+    trace::Span span {"book_prices"};
+    auto fetch = std::make_shared<BookFetch>();
+    fetch->uids = std::move(uid);
+    fetch->asks.resize(fetch->uids.size());
+    fetch->next = 0;
+    fetch->completed = 0;
+    fetch->expired = false;
+
+    // Each completed request issues the next one, so at most book_concurrency
+    // requests are in flight at any time.
+    auto concurrency = std::min(static_cast<size_t>(std::max(config.broker.book_concurrency, 1)), fetch->uids.size());
+    for (size_t i = 0; i < concurrency; i++) {
+        load_next_book_price(fetch);
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.broker.book_timeout_ms);
+    std::unique_lock<std::mutex> lock(fetch->m);
+    if (!fetch->cv.wait_until(lock, deadline, [&]() { return fetch->completed == fetch->uids.size(); })) {
+        static auto& timeouts_total = metrics::Registry::shared().counter(
+            "sscan_book_fetch_timeouts_total", "Book price fetches cut short by the timeout").with({});
+        timeouts_total.inc();
+        BOOST_LOG_TRIVIAL(warning) << "Book prices timed out: " << std::to_string(fetch->completed) 
+            << " of " << std::to_string(fetch->uids.size());
+    }
+    fetch->expired = true;
+
+    return fetch;
+}
+
+void PriceLoader::load_next_book_price(const std::shared_ptr<BookFetch>& fetch) {
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(fetch->m);
+        if (fetch->expired || fetch->next >= fetch->uids.size()) {
+            return;
+        }
+        index = fetch->next++;
+    }
+
+    auto request = BookRequest { .uid = fetch->uids[index], .depth = 1 };
+    client.async_post(config.broker.book_price_path, to_json(request),
+        [this, fetch, index](std::exception_ptr error, std::string response) {
+            static auto& fetches_total = metrics::Registry::shared().counter(
+                "sscan_book_fetches_total", "Book price requests by result", {"result"});
+            static auto& fetches_ok = fetches_total.with({"ok"});
+            static auto& fetches_error = fetches_total.with({"error"});
+
+            long ask_price = 0;
+            try {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+                ask_price = parse<BookResponse>(response).ask_price;
+                fetches_ok.inc();
+            } catch (const std::exception& ex) {
+                fetches_error.inc();
+                BOOST_LOG_TRIVIAL(warning) << "Error loading book price: " << ex.what();
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(fetch->m);
+                fetch->asks[index] = ask_price;
+                fetch->completed++;
+            }
+            fetch->cv.notify_all();
+
+            load_next_book_price(fetch);
+        });
+}
+
+bool PriceLoader::subscribe(const std::vector<boost::uuids::uuid>& uid, const PriceBatchHandler& handler) {
+    if (!stream) {
+        return false;
+    }
+
+    stream->start(handler);
+    stream->subscribe(uid);
+    return true;
+}
+
+bool PriceLoader::is_streaming() const {
+    return stream && stream->is_connected();
+}
+
+u_int64_t PriceLoader::get_stream_generation() const {
+    return stream ? stream->get_generation() : 0;
+}
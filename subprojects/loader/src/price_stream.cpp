@@ -0,0 +1,287 @@
+#include "price_stream.h"
+#include "dto.h"
+
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+
+namespace beast = boost::beast;
+namespace asio = boost::asio;
+namespace ssl = asio::ssl;
+namespace ip = asio::ip;
+namespace websocket = beast::websocket;
+
+const auto PRICE_STREAM_CONNECT_TIMEOUT = std::chrono::seconds(30);
+const auto PRICE_STREAM_MIN_BACKOFF = std::chrono::milliseconds(1000);
+const auto PRICE_STREAM_MAX_BACKOFF = std::chrono::milliseconds(60000);
+// Nothing received for this long, pings included, means a half-open connection
+const auto PRICE_STREAM_IDLE_TIMEOUT = std::chrono::seconds(60);
+
+PriceStream::PriceStream(
+    const std::string& a_host,
+    const std::string& a_port,
+    const std::string& a_path,
+    const std::string& a_auth,
+    const size_t a_batch_size) :
+    host {a_host},
+    port {a_port},
+    path {a_path},
+    auth {a_auth},
+    batch_size {std::max<size_t>(a_batch_size, 1)},
+    context {http::IoContext::shared()},
+    strand {asio::make_strand(context->get_io())},
+    resolver {strand},
+    reconnect_timer {strand},
+    connection {},
+    session {0},
+    backoff {PRICE_STREAM_MIN_BACKOFF},
+    handler {},
+    wanted {},
+    subscribed {},
+    started {false},
+    stopped {false},
+    connected {false},
+    generation {0} {}
+
+void PriceStream::start(PriceBatchHandler a_handler) {
+    if (started.exchange(true)) {
+        return;
+    }
+
+    asio::post(strand, [self = shared_from_this(), a_handler = std::move(a_handler)]() {
+        self->handler = std::move(a_handler);
+        self->connect();
+    });
+}
+
+void PriceStream::subscribe(const std::vector<boost::uuids::uuid>& uids) {
+    asio::post(strand, [self = shared_from_this(), uids = UidsSet {uids.begin(), uids.end()}]() mutable {
+        self->wanted = std::move(uids);
+        self->sync_subscriptions();
+    });
+}
+
+void PriceStream::stop() {
+    stopped = true;
+    asio::post(strand, [self = shared_from_this()]() {
+        self->connected = false;
+        self->reconnect_timer.cancel();
+        self->resolver.cancel();
+        if (self->connection) {
+            beast::error_code ec;
+            beast::get_lowest_layer(self->connection->ws).socket().close(ec);
+        }
+    });
+}
+
+bool PriceStream::is_connected() const {
+    return connected;
+}
+
+u_int64_t PriceStream::get_generation() const {
+    return generation;
+}
+
+void PriceStream::connect() {
+    if (stopped) {
+        return;
+    }
+
+    auto current = ++session;
+    connection = std::make_shared<Connection>(strand, context->get_ssl());
+    subscribed.clear();
+
+    auto conn = connection;
+    if (!SSL_set_tlsext_host_name(conn->ws.next_layer().native_handle(), host.c_str())) {
+        fail(current, "handshake", beast::error_code {static_cast<int>(::ERR_get_error()), asio::error::get_ssl_category()});
+        return;
+    }
+
+    resolver.async_resolve(host, port,
+        [self = shared_from_this(), current, conn](beast::error_code ec, ip::tcp::resolver::results_type results) {
+            if (ec) {
+                self->fail(current, "resolve", ec);
+                return;
+            }
+
+            auto& tcp_stream = beast::get_lowest_layer(conn->ws);
+            tcp_stream.expires_after(PRICE_STREAM_CONNECT_TIMEOUT);
+            tcp_stream.async_connect(results, [self, current, conn](beast::error_code ec, ip::tcp::endpoint) {
+                if (ec) {
+                    self->fail(current, "connect", ec);
+                    return;
+                }
+
+                conn->ws.next_layer().async_handshake(ssl::stream_base::client, [self, current, conn](beast::error_code ec) {
+                    if (ec) {
+                        self->fail(current, "handshake", ec);
+                        return;
+                    }
+
+                    // From here on the websocket stream pings the broker when it goes quiet
+                    // and fails the read once nothing has arrived for the idle timeout
+                    beast::get_lowest_layer(conn->ws).expires_never();
+                    auto timeout = websocket::stream_base::timeout::suggested(beast::role_type::client);
+                    timeout.idle_timeout = PRICE_STREAM_IDLE_TIMEOUT;
+                    timeout.keep_alive_pings = true;
+                    conn->ws.set_option(timeout);
+                    conn->ws.set_option(websocket::stream_base::decorator([auth = self->auth](websocket::request_type& request) {
+                        request.set(beast::http::field::user_agent, "Chrome/146.0.0.0");
+                        request.set(beast::http::field::sec_websocket_protocol, "json");
+                        if (auth.length() > 0) {
+                            request.set(beast::http::field::authorization, auth);
+                        }
+                    }));
+
+                    conn->ws.async_handshake(self->host, self->path, [self, current](beast::error_code ec) {
+                        if (ec) {
+                            self->fail(current, "handshake", ec);
+                            return;
+                        }
+
+                        self->on_connected(current);
+                    });
+                });
+            });
+        });
+}
+
+void PriceStream::on_connected(const u_int64_t current) {
+    if (current != session) {
+        return;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Price stream connected: " << host;
+
+    connected = true;
+    backoff = PRICE_STREAM_MIN_BACKOFF;
+    read(current, connection);
+    sync_subscriptions();
+}
+
+void PriceStream::read(const u_int64_t current, std::shared_ptr<Connection> conn) {
+    conn->ws.async_read(conn->buffer, [self = shared_from_this(), current, conn](beast::error_code ec, size_t) {
+        if (current != self->session) {
+            return;
+        }
+
+        if (ec) {
+            self->fail(current, "read", ec);
+            return;
+        }
+
+        auto data = conn->buffer.data();
+        auto message = std::string_view {static_cast<const char*>(data.data()), data.size()};
+
+        auto prices = PriceMap();
+        try {
+            parse_last_price(message, prices);
+        } catch (const std::exception& ex) {
+            BOOST_LOG_TRIVIAL(warning) << "Error parsing price stream message: " << ex.what();
+        }
+        conn->buffer.consume(conn->buffer.size());
+
+        if (!prices.empty()) {
+            try {
+                self->handler(std::move(prices));
+            } catch (const std::exception& ex) {
+                BOOST_LOG_TRIVIAL(error) << "Error handling price update: " << ex.what();
+            }
+        }
+
+        self->read(current, conn);
+    });
+}
+
+void PriceStream::send(std::string message) {
+    connection->outbox.push_back(std::move(message));
+    if (!connection->writing) {
+        write_next(session, connection);
+    }
+}
+
+void PriceStream::write_next(const u_int64_t current, std::shared_ptr<Connection> conn) {
+    if (conn->outbox.empty()) {
+        conn->writing = false;
+        return;
+    }
+
+    conn->writing = true;
+    conn->ws.text(true);
+    conn->ws.async_write(asio::buffer(conn->outbox.front()), [self = shared_from_this(), current, conn](beast::error_code ec, size_t) {
+        if (current != self->session) {
+            return;
+        }
+
+        if (ec) {
+            self->fail(current, "write", ec);
+            return;
+        }
+
+        conn->outbox.pop_front();
+        self->write_next(current, conn);
+    });
+}
+
+void PriceStream::sync_subscriptions() {
+    if (!connected) {
+        return;
+    }
+
+    auto added = std::vector<boost::uuids::uuid>();
+    for (auto& uid : wanted) {
+        if (!subscribed.contains(uid)) {
+            added.push_back(uid);
+        }
+    }
+
+    auto removed = std::vector<boost::uuids::uuid>();
+    for (auto& uid : subscribed) {
+        if (!wanted.contains(uid)) {
+            removed.push_back(uid);
+        }
+    }
+
+    auto send_batches = [&](const std::vector<boost::uuids::uuid>& uids, bool subscribe) {
+        for (size_t offset = 0; offset < uids.size(); offset += batch_size) {
+            auto last = std::min(offset + batch_size, uids.size());
+            send(to_json(LastPriceSubscriptionRequest {
+                .subscribe = subscribe,
+                .instrument_id = {uids.begin() + offset, uids.begin() + last}
+            }));
+        }
+    };
+    send_batches(removed, false);
+    send_batches(added, true);
+
+    subscribed = wanted;
+    if (!added.empty()) {
+        generation++;
+        BOOST_LOG_TRIVIAL(debug) << "Price stream subscribed: " << std::to_string(added.size())
+            << ", unsubscribed: " << std::to_string(removed.size());
+    }
+}
+
+void PriceStream::fail(const u_int64_t current, const std::string& what, beast::error_code ec) {
+    if (current != session || stopped) {
+        return;
+    }
+
+    BOOST_LOG_TRIVIAL(warning) << "Price stream " << what << " error: " << host << " " << ec.message();
+
+    connected = false;
+    session++;
+    if (connection) {
+        beast::error_code close_ec;
+        beast::get_lowest_layer(connection->ws).socket().close(close_ec);
+    }
+
+    reconnect_timer.expires_after(backoff);
+    reconnect_timer.async_wait([self = shared_from_this()](beast::error_code ec) {
+        if (ec) {
+            return;
+        }
+
+        self->connect();
+    });
+    backoff = std::min(backoff * 2, PRICE_STREAM_MAX_BACKOFF);
+}
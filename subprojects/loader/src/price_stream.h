@@ -0,0 +1,90 @@
+#ifndef SECURITIES_SCANNER_LOADER_PRICE_STREAM_H
+#define SECURITIES_SCANNER_LOADER_PRICE_STREAM_H
+
+#include <sscan/http.h>
+#include <sscan/price_loader.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+// Last price subscription over the broker's websocket market data stream.
+// All state lives on a strand; the connection is re-established with backoff
+// and the wanted instruments are re-subscribed after every reconnect. Every
+// connection has its own stream, buffer and outgoing queue, so operations still
+// pending on a dropped connection finish on their own objects.
+class PriceStream : public std::enable_shared_from_this<PriceStream> {
+    public:
+        PriceStream(
+            const std::string& host,
+            const std::string& port,
+            const std::string& path,
+            const std::string& auth,
+            const size_t batch_size);
+
+        PriceStream(const PriceStream& other) = delete;
+        PriceStream& operator=(const PriceStream& other) = delete;
+
+        void start(PriceBatchHandler handler);
+        void subscribe(const std::vector<boost::uuids::uuid>& uids);
+        void stop();
+
+        bool is_connected() const;
+        // Incremented whenever instruments are (re)subscribed, i.e. whenever
+        // updates might have been missed and a full price poll is due.
+        u_int64_t get_generation() const;
+    private:
+        using ws_t = boost::beast::websocket::stream<boost::beast::ssl_stream<boost::beast::tcp_stream>>;
+        using UidsSet = std::unordered_set<boost::uuids::uuid, boost::hash<boost::uuids::uuid>>;
+
+        struct Connection {
+            Connection(const boost::asio::strand<boost::asio::io_context::executor_type>& strand, boost::asio::ssl::context& ssl) :
+                ws {strand, ssl},
+                buffer {},
+                outbox {},
+                writing {false} {}
+
+            ws_t ws;
+            boost::beast::flat_buffer buffer;
+            std::deque<std::string> outbox;
+            bool writing;
+        };
+
+        const std::string host;
+        const std::string port;
+        const std::string path;
+        const std::string auth;
+        const size_t batch_size;
+        const std::shared_ptr<http::IoContext> context;
+
+        boost::asio::strand<boost::asio::io_context::executor_type> strand;
+        boost::asio::ip::tcp::resolver resolver;
+        boost::asio::steady_timer reconnect_timer;
+        std::shared_ptr<Connection> connection;
+        u_int64_t session;
+        std::chrono::milliseconds backoff;
+        PriceBatchHandler handler;
+        UidsSet wanted;
+        UidsSet subscribed;
+
+        std::atomic<bool> started;
+        std::atomic<bool> stopped;
+        std::atomic<bool> connected;
+        std::atomic<u_int64_t> generation;
+
+        void connect();
+        void on_connected(const u_int64_t session);
+        void read(const u_int64_t session, std::shared_ptr<Connection> current_connection);
+        void send(std::string message);
+        void write_next(const u_int64_t session, std::shared_ptr<Connection> current_connection);
+        void sync_subscriptions();
+        void fail(const u_int64_t session, const std::string& what, boost::beast::error_code ec);
+};
+
+#endif // SECURITIES_SCANNER_LOADER_PRICE_STREAM_H
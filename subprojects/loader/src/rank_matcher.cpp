@@ -0,0 +1,378 @@
+#include "rank_matcher.h"
+
+#include <cctype>
+#include <limits>
+
+namespace {
+
+    using charset = std::bitset<256>;
+
+    const size_t UNBOUNDED = std::numeric_limits<size_t>::max();
+
+    charset single(const unsigned char c) {
+        charset chars;
+        chars.set(c);
+        return chars;
+    }
+
+    charset range(const unsigned char from, const unsigned char to) {
+        charset chars;
+        for (unsigned int c = from; c <= to; c++) {
+            chars.set(c);
+        }
+        return chars;
+    }
+
+    charset digits() {
+        return range('0', '9');
+    }
+
+    charset word() {
+        return range('a', 'z') | range('A', 'Z') | digits() | single('_');
+    }
+
+    charset spaces() {
+        return single(' ') | single('\t') | single('\n') | single('\r') | single('\f') | single('\v');
+    }
+
+    // Character set of an escape sequence, std::nullopt for escapes that are not
+    // plain characters (word boundaries, backreferences).
+    std::optional<charset> escape(const char c) {
+        switch (c) {
+            case 'd': return digits();
+            case 'D': return ~digits();
+            case 'w': return word();
+            case 'W': return ~word();
+            case 's': return spaces();
+            case 'S': return ~spaces();
+            case 't': return single('\t');
+            case 'n': return single('\n');
+            case 'r': return single('\r');
+            case 'f': return single('\f');
+            case 'v': return single('\v');
+            case 'b':
+            case 'B':
+            case 'c':
+            case 'x':
+            case 'u':
+                return std::nullopt;
+            default:
+                if (std::isalnum(static_cast<unsigned char>(c))) {
+                    return std::nullopt;
+                }
+                return single(static_cast<unsigned char>(c));
+        }
+    }
+
+    bool read_count(const std::string& pattern, size_t& i, size_t& count) {
+        size_t start = i;
+        count = 0;
+        while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) {
+            count = count * 10 + (pattern[i] - '0');
+            i++;
+        }
+        return i > start;
+    }
+
+}
+
+RankMatcher::RankMatcher(const std::string& pattern) {
+    if (!compile(pattern)) {
+        atoms.clear();
+        capture_begin.reset();
+        capture_end.reset();
+        prefix.clear();
+        fallback.emplace(pattern);
+    }
+}
+
+bool RankMatcher::compile(const std::string& pattern) {
+    bool in_group = false;
+    bool capturing = false;
+    size_t group_start = 0;
+
+    size_t i = 0;
+    while (i < pattern.size()) {
+        char c = pattern[i++];
+        charset chars;
+
+        switch (c) {
+            case '(':
+                if (in_group) {
+                    return false;
+                }
+                in_group = true;
+                group_start = atoms.size();
+                capturing = pattern.compare(i, 2, "?:") != 0;
+                if (!capturing) {
+                    i += 2;
+                } else if (i < pattern.size() && pattern[i] == '?') {
+                    return false;
+                }
+                continue;
+            case ')':
+                if (!in_group) {
+                    return false;
+                }
+                if (i < pattern.size() && std::string_view {"*+?{"}.find(pattern[i]) != std::string_view::npos) {
+                    return false;
+                }
+                in_group = false;
+                if (capturing && !capture_begin.has_value()) {
+                    capture_begin = group_start;
+                    capture_end = atoms.size();
+                }
+                continue;
+            case '|':
+            case '^':
+            case '$':
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+                return false;
+            case '.':
+                chars = ~(single('\n') | single('\r'));
+                break;
+            case '\\': {
+                if (i == pattern.size()) {
+                    return false;
+                }
+                auto escaped = escape(pattern[i++]);
+                if (!escaped.has_value()) {
+                    return false;
+                }
+                chars = escaped.value();
+                break;
+            }
+            case '[': {
+                bool negate = i < pattern.size() && pattern[i] == '^';
+                if (negate) {
+                    i++;
+                }
+
+                bool closed = false;
+                while (i < pattern.size()) {
+                    char from = pattern[i++];
+                    if (from == ']') {
+                        closed = true;
+                        break;
+                    }
+
+                    if (from == '\\') {
+                        if (i == pattern.size()) {
+                            return false;
+                        }
+                        auto escaped = escape(pattern[i++]);
+                        if (!escaped.has_value()) {
+                            return false;
+                        }
+                        chars |= escaped.value();
+                        continue;
+                    }
+
+                    if (i + 1 < pattern.size() && pattern[i] == '-' && pattern[i + 1] != ']') {
+                        char to = pattern[i + 1];
+                        if (to == '\\' || static_cast<unsigned char>(to) < static_cast<unsigned char>(from)) {
+                            return false;
+                        }
+                        chars |= range(from, to);
+                        i += 2;
+                        continue;
+                    }
+
+                    chars.set(static_cast<unsigned char>(from));
+                }
+
+                if (!closed) {
+                    return false;
+                }
+                if (negate) {
+                    chars = ~chars;
+                }
+                break;
+            }
+            default:
+                chars = single(static_cast<unsigned char>(c));
+                break;
+        }
+
+        size_t min = 1;
+        size_t max = 1;
+        if (i < pattern.size()) {
+            switch (pattern[i]) {
+                case '*':
+                    min = 0;
+                    max = UNBOUNDED;
+                    i++;
+                    break;
+                case '+':
+                    max = UNBOUNDED;
+                    i++;
+                    break;
+                case '?':
+                    min = 0;
+                    i++;
+                    break;
+                case '{': {
+                    i++;
+                    if (!read_count(pattern, i, min)) {
+                        return false;
+                    }
+                    max = min;
+                    if (i < pattern.size() && pattern[i] == ',') {
+                        i++;
+                        if (!read_count(pattern, i, max)) {
+                            max = UNBOUNDED;
+                        }
+                    }
+                    if (i == pattern.size() || pattern[i] != '}' || max < min) {
+                        return false;
+                    }
+                    i++;
+                    break;
+                }
+            }
+        }
+
+        if (i < pattern.size() && std::string_view {"*+?{"}.find(pattern[i]) != std::string_view::npos) {
+            return false;
+        }
+
+        atoms.push_back(Atom { .chars = chars, .min = min, .max = max });
+    }
+
+    if (in_group || atoms.empty()) {
+        return false;
+    }
+
+    for (auto& atom : atoms) {
+        if (atom.min != 1 || atom.max != 1 || atom.chars.count() != 1) {
+            break;
+        }
+        for (unsigned int c = 0; c < 256; c++) {
+            if (atom.chars.test(c)) {
+                prefix.push_back(static_cast<char>(c));
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+RankMatcher::Scan RankMatcher::scan() const {
+    return Scan {*this};
+}
+
+void RankMatcher::find_all(std::string_view text, const MatchHandler& handler) const {
+    auto scan = this->scan();
+    scan.feed(text, handler);
+    scan.finish(handler);
+}
+
+size_t RankMatcher::search(std::string_view text, const bool at_end, const MatchHandler& handler) const {
+    std::vector<size_t> positions(atoms.size() + 1);
+
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t start = pos;
+        if (!prefix.empty()) {
+            start = text.find(prefix, pos);
+            if (start == std::string_view::npos) {
+                // The tail may hold the beginning of a prefix completed by the next chunk
+                return at_end ? text.size() : std::max(pos, text.size() - std::min(text.size(), prefix.size() - 1));
+            }
+        }
+
+        switch (match(text, 0, start, at_end, positions)) {
+            case Result::MATCH:
+                if (capture_begin.has_value()) {
+                    size_t begin = positions[capture_begin.value()];
+                    size_t end = positions[capture_end.value()];
+                    handler(text.substr(begin, end - begin));
+                }
+                pos = std::max(positions[atoms.size()], start + 1);
+                break;
+            case Result::NO_MATCH:
+                pos = start + 1;
+                break;
+            case Result::NEED_MORE:
+                return start;
+        }
+    }
+
+    return text.size();
+}
+
+// Greedy backtracking over the atom chain. Any decision that depends on input
+// past the end of a partial buffer yields NEED_MORE, so the caller keeps the
+// text from the candidate start and retries once more data has arrived.
+RankMatcher::Result RankMatcher::match(
+    std::string_view text,
+    const size_t atom,
+    const size_t pos,
+    const bool at_end,
+    std::vector<size_t>& positions) const {
+
+    positions[atom] = pos;
+    if (atom == atoms.size()) {
+        return Result::MATCH;
+    }
+
+    auto& current = atoms[atom];
+    size_t count = 0;
+    while (count < current.max && pos + count < text.size() &&
+        current.chars.test(static_cast<unsigned char>(text[pos + count]))) {
+        count++;
+    }
+
+    if (!at_end && count < current.max && pos + count == text.size()) {
+        return Result::NEED_MORE;
+    }
+
+    if (count < current.min) {
+        return Result::NO_MATCH;
+    }
+
+    for (size_t taken = count + 1; taken-- > current.min;) {
+        auto result = match(text, atom + 1, pos + taken, at_end, positions);
+        if (result != Result::NO_MATCH) {
+            return result;
+        }
+    }
+
+    return Result::NO_MATCH;
+}
+
+RankMatcher::Scan::Scan(const RankMatcher& a_matcher) : matcher {a_matcher}, pending {} {}
+
+void RankMatcher::Scan::feed(std::string_view chunk, const MatchHandler& handler) {
+    pending.append(chunk);
+    if (matcher.fallback.has_value()) {
+        return;
+    }
+
+    size_t consumed = matcher.search(pending, false, handler);
+    pending.erase(0, consumed);
+}
+
+void RankMatcher::Scan::finish(const MatchHandler& handler) {
+    if (!matcher.fallback.has_value()) {
+        matcher.search(pending, true, handler);
+        pending.clear();
+        return;
+    }
+
+    std::sregex_iterator it(pending.begin(), pending.end(), matcher.fallback.value());
+    std::sregex_iterator end;
+    for (; it != end; it++) {
+        auto& match = *it;
+        if (match.size() < 2) {
+            continue;
+        }
+
+        handler(std::string_view {pending}.substr(match.position(1), match.length(1)));
+    }
+    pending.clear();
+}
@@ -0,0 +1,64 @@
+#ifndef SECURITIES_SCANNER_LOADER_RANK_MATCHER_H
+#define SECURITIES_SCANNER_LOADER_RANK_MATCHER_H
+
+#include <bitset>
+#include <functional>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using MatchHandler = std::function<void (std::string_view capture)>;
+
+// Finds all matches of the rank page regex and reports the first capture group.
+// The pattern is compiled into a chain of character-set atoms with greedy
+// repetition counts, searched for by its literal prefix and matched by a small
+// backtracking engine with std::regex_search semantics. Patterns that use
+// anything beyond that (alternation, anchors, nested or repeated groups,
+// lazy quantifiers, backreferences) are handed to std::regex instead.
+class RankMatcher {
+    public:
+        explicit RankMatcher(const std::string& pattern);
+
+        // Incremental search over a document that arrives in chunks. Matches are
+        // reported as soon as they can no longer be extended by later input.
+        class Scan {
+            public:
+                explicit Scan(const RankMatcher& matcher);
+
+                void feed(std::string_view chunk, const MatchHandler& handler);
+                void finish(const MatchHandler& handler);
+            private:
+                const RankMatcher& matcher;
+                std::string pending;
+        };
+
+        Scan scan() const;
+        void find_all(std::string_view text, const MatchHandler& handler) const;
+    private:
+        struct Atom {
+            std::bitset<256> chars;
+            size_t min;
+            size_t max;
+        };
+
+        enum class Result { MATCH, NO_MATCH, NEED_MORE };
+
+        std::vector<Atom> atoms;
+        std::optional<size_t> capture_begin;
+        std::optional<size_t> capture_end;
+        std::string prefix;
+        std::optional<std::regex> fallback;
+
+        bool compile(const std::string& pattern);
+        size_t search(std::string_view text, const bool at_end, const MatchHandler& handler) const;
+        Result match(
+            std::string_view text,
+            const size_t atom,
+            const size_t pos,
+            const bool at_end,
+            std::vector<size_t>& positions) const;
+};
+
+#endif // SECURITIES_SCANNER_LOADER_RANK_MATCHER_H
@@ -1,24 +1,83 @@
 #include <sscan/rate_limiter.h>
 
+#include <boost/asio/steady_timer.hpp>
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
+#include <unordered_map>
 
 using namespace http;
 
-RateLimiter::RateLimiter(const int a_rps) : 
-    rps {a_rps}, requests {0}, last_reset {std::chrono::system_clock::now()} {};
+int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RateLimiter::RateLimiter(const int a_rps, const int a_burst, const std::string& name) : 
+    rps {std::max(a_rps, 1)},
+    burst {std::max(a_burst, 1)},
+    interval_ns {1000000000 / rps},
+    tolerance_ns {interval_ns * (burst - 1)},
+    arrival_ns {steady_now_ns()},
+    wait_seconds {metrics::Registry::shared()
+        .histogram("sscan_rate_limiter_wait_seconds", "Time requests wait for a rate limiter slot", {"limiter"})
+        .with({name})},
+    throttled_total {metrics::Registry::shared()
+        .counter("sscan_rate_limiter_throttled_total", "Requests delayed by a rate limiter", {"limiter"})
+        .with({name})} {};
+
+std::chrono::nanoseconds RateLimiter::reserve() {
+    auto now = steady_now_ns();
+    auto arrival = arrival_ns.load(std::memory_order_relaxed);
+    int64_t start;
+    do {
+        start = std::max(arrival, now);
+    } while (!arrival_ns.compare_exchange_weak(arrival, start + interval_ns, std::memory_order_relaxed));
+
+    auto wait = std::max<int64_t>(start - tolerance_ns - now, 0);
+
+    wait_seconds.observe(std::chrono::nanoseconds(wait));
+    if (wait > 0) {
+        throttled_total.inc();
+    }
+
+    return std::chrono::nanoseconds(wait);
+}
 
 void RateLimiter::acquire() {
-    requests++;
-    if (requests <= rps) {
-        return;
+    auto wait = reserve();
+    if (wait.count() > 0) {
+        std::this_thread::sleep_for(wait);
     }
+}
 
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - last_reset).count();
-    auto time_to_wait = 1000 - elapsed;
-    if (time_to_wait > 0) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(time_to_wait));
+void RateLimiter::async_acquire(boost::asio::io_context& io, std::function<void ()> handler) {
+    auto wait = reserve();
+    if (wait.count() == 0) {
+        handler();
+        return;
     }
-    last_reset = std::chrono::system_clock::now();
-    requests = 1;
+
+    auto timer = std::make_shared<boost::asio::steady_timer>(io, wait);
+    timer->async_wait([timer, handler = std::move(handler)](const boost::system::error_code&) {
+        handler();
+    });
 }
 
+std::shared_ptr<RateLimiter> RateLimiter::shared(const std::string& quota, const int rps, const int burst) {
+    static std::mutex m;
+    static std::unordered_map<std::string, std::weak_ptr<RateLimiter>> limiters;
+
+    std::lock_guard<std::mutex> lock(m);
+    auto limiter = limiters[quota].lock();
+    if (!limiter) {
+        limiter = std::make_shared<RateLimiter>(rps, burst, quota);
+        limiters[quota] = limiter;
+    } else if (limiter->rps != std::max(rps, 1) || limiter->burst != std::max(burst, 1)) {
+        throw std::invalid_argument {"Rate limiter " + quota + " is already shared at "
+            + std::to_string(limiter->rps) + " rps, burst " + std::to_string(limiter->burst)};
+    }
+
+    return limiter;
+}
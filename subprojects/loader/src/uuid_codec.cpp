@@ -0,0 +1,142 @@
+#include "uuid_codec.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Offsets of the five hex groups in the canonical form and their lengths in chars.
+constexpr size_t GROUP_OFFSETS[] = {0, 9, 14, 19, 24};
+constexpr size_t GROUP_SIZES[] = {8, 4, 4, 4, 12};
+constexpr size_t DASH_OFFSETS[] = {8, 13, 18, 23};
+
+constexpr std::array<int8_t, 256> make_hex_values() {
+    std::array<int8_t, 256> values {};
+    for (auto& value : values) {
+        value = -1;
+    }
+    for (int c = '0'; c <= '9'; c++) {
+        values[c] = c - '0';
+    }
+    for (int c = 'a'; c <= 'f'; c++) {
+        values[c] = c - 'a' + 10;
+        values[c - 'a' + 'A'] = c - 'a' + 10;
+    }
+    return values;
+}
+
+constexpr auto HEX_VALUES = make_hex_values();
+constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+bool hex_to_bytes(const char* hex, uint8_t* bytes) {
+#if defined(__SSE2__)
+    auto decode = [](__m128i c, __m128i& nibbles) {
+        auto digit = _mm_and_si128(
+            _mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), 
+            _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+        auto lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+        auto alpha = _mm_and_si128(
+            _mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), 
+            _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+
+        nibbles = _mm_or_si128(
+            _mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+            _mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+        return _mm_movemask_epi8(_mm_or_si128(digit, alpha)) == 0xffff;
+    };
+
+    // Every 16-bit lane holds the high nibble in its low byte and the low nibble
+    // in its high byte, so a shift and an or produce the byte in each lane.
+    auto combine = [](__m128i nibbles) {
+        return _mm_or_si128(
+            _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4),
+            _mm_srli_epi16(nibbles, 8));
+    };
+
+    __m128i first;
+    __m128i second;
+    if (!decode(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex)), first) || 
+        !decode(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 16)), second)) {
+        return false;
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), _mm_packus_epi16(combine(first), combine(second)));
+    return true;
+#else
+    for (size_t i = 0; i < 16; i++) {
+        auto high = HEX_VALUES[static_cast<uint8_t>(hex[2 * i])];
+        auto low = HEX_VALUES[static_cast<uint8_t>(hex[2 * i + 1])];
+        if ((high | low) < 0) {
+            return false;
+        }
+        bytes[i] = static_cast<uint8_t>(high << 4 | low);
+    }
+    return true;
+#endif
+}
+
+void bytes_to_hex(const uint8_t* bytes, char* hex) {
+#if defined(__SSE2__)
+    auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    auto mask = _mm_set1_epi8(0x0f);
+    auto high = _mm_and_si128(_mm_srli_epi16(value, 4), mask);
+    auto low = _mm_and_si128(value, mask);
+
+    auto to_ascii = [](__m128i nibbles) {
+        auto letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+        return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+    };
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(hex), to_ascii(_mm_unpacklo_epi8(high, low)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 16), to_ascii(_mm_unpackhi_epi8(high, low)));
+#else
+    for (size_t i = 0; i < 16; i++) {
+        hex[2 * i] = HEX_DIGITS[bytes[i] >> 4];
+        hex[2 * i + 1] = HEX_DIGITS[bytes[i] & 0x0f];
+    }
+#endif
+}
+
+bool parse_uuid(std::string_view text, boost::uuids::uuid& uid) {
+    if (text.size() != UUID_TEXT_SIZE) {
+        return false;
+    }
+
+    for (auto offset : DASH_OFFSETS) {
+        if (text[offset] != '-') {
+            return false;
+        }
+    }
+
+    char hex[32];
+    char* out = hex;
+    for (size_t i = 0; i < 5; i++) {
+        std::memcpy(out, text.data() + GROUP_OFFSETS[i], GROUP_SIZES[i]);
+        out += GROUP_SIZES[i];
+    }
+
+    return hex_to_bytes(hex, uid.data);
+}
+
+void format_uuid(const boost::uuids::uuid& uid, char* out) {
+    char hex[32];
+    bytes_to_hex(uid.data, hex);
+
+    const char* in = hex;
+    for (size_t i = 0; i < 5; i++) {
+        std::memcpy(out + GROUP_OFFSETS[i], in, GROUP_SIZES[i]);
+        in += GROUP_SIZES[i];
+    }
+    for (auto offset : DASH_OFFSETS) {
+        out[offset] = '-';
+    }
+}
+
+std::string format_uuid(const boost::uuids::uuid& uid) {
+    std::string text(UUID_TEXT_SIZE, '\0');
+    format_uuid(uid, text.data());
+    return text;
+}
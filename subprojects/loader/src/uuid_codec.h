@@ -0,0 +1,19 @@
+#ifndef SECURITIES_SCANNER_LOADER_UUID_CODEC_H
+#define SECURITIES_SCANNER_LOADER_UUID_CODEC_H
+
+#include <boost/uuid/uuid.hpp>
+#include <string>
+#include <string_view>
+
+constexpr size_t UUID_TEXT_SIZE = 36;
+
+// Parses the canonical 8-4-4-4-12 hex form, upper or lower case.
+// Returns false when the text is not a canonical uuid.
+bool parse_uuid(std::string_view text, boost::uuids::uuid& uid);
+
+// Writes the canonical lower case form, exactly UUID_TEXT_SIZE chars, no terminator.
+void format_uuid(const boost::uuids::uuid& uid, char* out);
+
+std::string format_uuid(const boost::uuids::uuid& uid);
+
+#endif // SECURITIES_SCANNER_LOADER_UUID_CODEC_H
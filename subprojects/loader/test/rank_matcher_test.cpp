@@ -0,0 +1,153 @@
+#include "rank_matcher.h"
+
+#include <iostream>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Checks RankMatcher against std::regex_search, which the rank page scan used
+// before, for whole documents and for documents split into chunks anywhere.
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        failures++;
+        if (failures <= 20) {
+            std::cerr << "FAILED: " << what << std::endl;
+        }
+    }
+}
+
+std::vector<std::string> expected_matches(const std::regex& regex, const std::string& text) {
+    auto matches = std::vector<std::string>();
+    std::sregex_iterator it(text.begin(), text.end(), regex);
+    std::sregex_iterator end;
+    for (; it != end; it++) {
+        if (it->size() >= 2) {
+            matches.push_back(it->str(1));
+        }
+    }
+    return matches;
+}
+
+std::vector<std::string> scan_matches(const RankMatcher& matcher, const std::string& text, const std::vector<size_t>& splits) {
+    auto matches = std::vector<std::string>();
+    auto handler = [&](std::string_view capture) { matches.emplace_back(capture); };
+    auto scan = matcher.scan();
+    size_t from = 0;
+    for (auto split : splits) {
+        scan.feed(std::string_view {text}.substr(from, split - from), handler);
+        from = split;
+    }
+    scan.feed(std::string_view {text}.substr(from), handler);
+    scan.finish(handler);
+    return matches;
+}
+
+std::string describe(const std::string& pattern, const std::string& text) {
+    auto shown = text.size() > 120 ? text.substr(0, 120) + "..." : text;
+    return "/" + pattern + "/ on \"" + shown + "\"";
+}
+
+void check_document(const std::string& pattern, const RankMatcher& matcher, const std::regex& regex,
+    const std::string& text, std::mt19937& random) {
+
+    auto expected = expected_matches(regex, text);
+    check(scan_matches(matcher, text, {}) == expected, describe(pattern, text) + " in one chunk");
+
+    // Every single split point of short documents, random chunks of the rest
+    if (text.size() <= 64) {
+        for (size_t split = 0; split <= text.size(); split++) {
+            check(scan_matches(matcher, text, {split}) == expected,
+                describe(pattern, text) + " split at " + std::to_string(split));
+        }
+        auto bytes = std::vector<size_t>();
+        for (size_t split = 1; split < text.size(); split++) {
+            bytes.push_back(split);
+        }
+        check(scan_matches(matcher, text, bytes) == expected, describe(pattern, text) + " byte by byte");
+    }
+
+    std::uniform_int_distribution<size_t> chunk {1, 40};
+    for (int round = 0; round < 4; round++) {
+        auto splits = std::vector<size_t>();
+        for (size_t split = chunk(random); split < text.size(); split += chunk(random)) {
+            splits.push_back(split);
+        }
+        check(scan_matches(matcher, text, splits) == expected, describe(pattern, text) + " in random chunks");
+    }
+}
+
+// Noise built from the characters the patterns care about, with ISIN-like runs mixed in
+std::string make_document(std::mt19937& random, const size_t size) {
+    static const std::string alphabet = "RUru0123456789ABCXYZ<>/td\"isnIS:=.- \n\r\t_";
+    static const std::vector<std::string> tokens = {
+        "RU000A0JX0J2", "RU000A105A95", "ru000a1053v3", "RU123456789", "RU12345678901",
+        "\"isin\":\"RU000A0ZZ1F6\"", "<td>RU000A101QE0</td>", "/bonds/RU000A1008V9/",
+        "ISIN=RU000A102BK7&", "12.345", "1.", ".5", "<td></td>",
+    };
+
+    std::uniform_int_distribution<size_t> pick_char {0, alphabet.size() - 1};
+    std::uniform_int_distribution<size_t> pick_token {0, tokens.size() - 1};
+    std::uniform_int_distribution<int> kind {0, 3};
+    std::string text;
+    while (text.size() < size) {
+        if (kind(random) == 0) {
+            text += tokens[pick_token(random)];
+        } else {
+            text += alphabet[pick_char(random)];
+        }
+    }
+    return text;
+}
+
+int main() {
+    const std::vector<std::string> patterns = {
+        // The pattern the rank pages are scanned with by default
+        "(RU[0-9]{10})",
+        "(RU[0-9A-Z]{10})",
+        "\"isin\":\"([A-Z]{2}[0-9A-Z]{9}\\d)\"",
+        "/bonds/(\\w{12})/",
+        "<td>(.*)</td>",
+        "<td>([^<]+)</td>",
+        "(?:ISIN|isin)=?(RU\\d{3}\\w{6}\\d?)",
+        "(\\d+)\\.\\d+",
+        "(\\d*)\\.",
+        "R?U?(\\d{3,5})",
+        "[Rr][Uu](\\S{10})",
+        "\\s(RU[0-9]{10})\\s",
+        "RU[0-9]{10}",
+        // Handed to std::regex
+        "(RU[0-9]{10})\\b",
+        "^(RU[0-9]{10})",
+        "(RU[0-9]{10}|ru[0-9a-z]{10})",
+        "(RU[0-9]+?)[A-Z]",
+        "((RU)[0-9]{10})",
+        "(RU(?:[0-9]{5}){2})",
+    };
+
+    std::mt19937 random {42};
+    for (auto& pattern : patterns) {
+        RankMatcher matcher {pattern};
+        std::regex regex {pattern};
+
+        check_document(pattern, matcher, regex, "", random);
+        check_document(pattern, matcher, regex, "RU0123456789", random);
+        check_document(pattern, matcher, regex, "xRU0123456789RU9876543210RU01234", random);
+        check_document(pattern, matcher, regex, "<td>RU000A0JX0J2</td><td>RU000A105A95</td>", random);
+        check_document(pattern, matcher, regex, "\"isin\":\"RU000A0ZZ1F6\" /bonds/RU000A1008V9/ 12.5 .", random);
+
+        for (int i = 0; i < 200; i++) {
+            check_document(pattern, matcher, regex, make_document(random, 16 + i * 4), random);
+        }
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
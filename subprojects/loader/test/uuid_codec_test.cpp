@@ -0,0 +1,113 @@
+#include "uuid_codec.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/uuid/string_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+// Checks parse_uuid and format_uuid against boost's string conversions, the
+// reference the codec replaced.
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        failures++;
+        if (failures <= 20) {
+            std::cerr << "FAILED: " << what << std::endl;
+        }
+    }
+}
+
+void check_round_trip(const boost::uuids::uuid& uid) {
+    auto expected = boost::uuids::to_string(uid);
+    auto text = format_uuid(uid);
+    check(text == expected, "format " + expected + " gave " + text);
+
+    boost::uuids::uuid parsed {};
+    check(parse_uuid(text, parsed) && parsed == uid, "parse " + text);
+
+    auto upper = text;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+    parsed = {};
+    check(parse_uuid(upper, parsed) && parsed == uid, "parse " + upper);
+}
+
+void check_rejected(const std::string& text) {
+    boost::uuids::uuid parsed {};
+    check(!parse_uuid(text, parsed), "accepted " + text);
+}
+
+bool is_hex(unsigned char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+int main() {
+    // Every byte value at every position, which covers every nibble in both halves of a lane
+    for (size_t position = 0; position < 16; position++) {
+        for (int value = 0; value < 256; value++) {
+            boost::uuids::uuid uid {};
+            uid.data[position] = static_cast<uint8_t>(value);
+            check_round_trip(uid);
+            std::fill(std::begin(uid.data), std::end(uid.data), 0xff);
+            uid.data[position] = static_cast<uint8_t>(value);
+            check_round_trip(uid);
+        }
+    }
+
+    std::mt19937_64 random {42};
+    std::uniform_int_distribution<int> byte {0, 255};
+    boost::uuids::string_generator generator;
+    for (int i = 0; i < 100000; i++) {
+        boost::uuids::uuid uid;
+        for (auto& b : uid.data) {
+            b = static_cast<uint8_t>(byte(random));
+        }
+        check_round_trip(uid);
+
+        auto mixed = boost::uuids::to_string(uid);
+        for (auto& c : mixed) {
+            if (random() & 1) {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+        }
+        boost::uuids::uuid parsed {};
+        check(parse_uuid(mixed, parsed) && parsed == generator(mixed), "parse " + mixed);
+    }
+
+    auto valid = std::string {"0123abcd-4567-89ef-ABCD-0123456789ef"};
+    boost::uuids::uuid parsed {};
+    check(parse_uuid(valid, parsed) && parsed == generator(valid), "parse " + valid);
+
+    // Every other char in every position
+    for (size_t position = 0; position < valid.size(); position++) {
+        auto dash = position == 8 || position == 13 || position == 18 || position == 23;
+        for (int c = 0; c < 256; c++) {
+            if (dash ? c == '-' : is_hex(static_cast<unsigned char>(c))) {
+                continue;
+            }
+            auto text = valid;
+            text[position] = static_cast<char>(c);
+            check_rejected(text);
+        }
+    }
+
+    check_rejected("");
+    check_rejected(valid.substr(1));
+    check_rejected(valid + "0");
+    check_rejected("{" + valid.substr(1, 34) + "}");
+    check_rejected("0123abcd04567-89ef-ABCD-0123456789e");
+    check_rejected("0123abcd456789efABCD0123456789ef");
+    check_rejected("0123abcd45-6789ef-ABCD-0123456789ef");
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
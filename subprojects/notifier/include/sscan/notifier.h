@@ -7,11 +7,16 @@
 #include <tgbot/tgbot.h>
 #include <vector>
 #include <chrono>
+#include <memory>
+#include <string_view>
 
 using zoned_time = std::chrono::zoned_time<std::chrono::_V2::system_clock::duration, const std::chrono::time_zone*>;
 
 struct BondsUpdateStats {
     u_int64_t total_bonds_loaded;
+    u_int64_t bonds_added;
+    u_int64_t bonds_removed;
+    u_int64_t bonds_updated;
 };
 
 struct BondYield {
@@ -28,6 +33,9 @@ struct PriceUpdateStats {
     std::vector<BondYield> new_prices;
 };
 
+struct MessageTemplates;
+class CommandRouter;
+
 enum class WorkingState { WORKING, IDLE, OVERTIME, HOLIDAY };
 
 struct ScannerStats {
@@ -41,11 +49,17 @@ struct ScannerStats {
 
     double min_ytm;
     int min_dtm;
+
+    u_int64_t price_cycles;
+    u_int64_t price_cycles_skipped;
+    u_int64_t tick_batches;
+    u_int64_t alerts_sent;
 };
 
 class Notifier {
     public:
         Notifier(const Config& config, boost::asio::thread_pool& thread_pool);
+        ~Notifier();
 
         Notifier(const Notifier& other) = delete;
         Notifier& operator=(const Notifier& other) = delete;
@@ -70,8 +84,11 @@ class Notifier {
         void on_reload(const std::function<void ()>& func);
         void on_working_state_change(const std::function<void (WorkingState)>& func);
     private:
+        class Outbox;
+
         const Config& config;
         boost::asio::thread_pool& thread_pool;
+        TgBot::BoostHttpOnlySslClient tgbot_client;
         TgBot::Bot tgbot;
 
         std::function<ScannerStats ()> on_stats_requested_func;
@@ -79,15 +96,18 @@ class Notifier {
         std::function<void (int)> on_target_dtm_change_func;
         std::function<void ()> on_reload_func;
         std::function<void (WorkingState)> on_working_state_change_func;
-
+        std::unique_ptr<const MessageTemplates> templates;
+        std::unique_ptr<CommandRouter> router;
+        std::unique_ptr<Outbox> outbox;
 
         void handle_message(TgBot::Message::Ptr message);
         void handle_stats_message();
-        void handle_ytm_message(TgBot::Message::Ptr message);
-        void handle_dtm_message(TgBot::Message::Ptr message);
+        void handle_ytm_message(std::string_view args);
+        void handle_dtm_message(std::string_view args);
         void handle_reload_message();
         void long_poll();
         void send_message(const std::string& message);
+        void deliver(const std::string& message);
 };
 
 #endif // SECURITIES_SCANNER_NOTIFIER_H
\ No newline at end of file
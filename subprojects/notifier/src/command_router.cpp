@@ -0,0 +1,48 @@
+#include "command_router.h"
+
+#include <boost/asio/post.hpp>
+#include <boost/log/trivial.hpp>
+
+CommandRouter::CommandRouter(boost::asio::thread_pool& a_thread_pool) :
+    thread_pool {a_thread_pool},
+    routes {},
+    strands {} {};
+
+void CommandRouter::route(const std::string& command, Handler handler) {
+    routes[command] = std::move(handler);
+}
+
+bool CommandRouter::dispatch(const int64_t chat_id, std::string_view text) {
+    if (!text.starts_with('/')) {
+        return false;
+    }
+
+    auto command_end = text.find_first_of(" \n");
+    auto command = text.substr(0, command_end);
+    command = command.substr(0, command.find('@'));
+
+    auto route_it = routes.find(command);
+    if (route_it == routes.end()) {
+        return false;
+    }
+
+    auto args = command_end == std::string_view::npos ? std::string {} : std::string {text.substr(command_end + 1)};
+    boost::asio::post(strand_for(chat_id), [&route = *route_it, args = std::move(args)]() {
+        try {
+            route.second(args);
+        } catch (const std::exception& ex) {
+            BOOST_LOG_TRIVIAL(error) << "Error handling " << route.first << ": " << ex.what();
+        }
+    });
+    return true;
+}
+
+CommandRouter::Strand& CommandRouter::strand_for(const int64_t chat_id) {
+    std::lock_guard<std::mutex> lock(m);
+    auto strand_it = strands.find(chat_id);
+    if (strand_it == strands.end()) {
+        strand_it = strands.emplace(chat_id, boost::asio::make_strand(thread_pool)).first;
+    }
+
+    return strand_it->second;
+}
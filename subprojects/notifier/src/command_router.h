@@ -0,0 +1,76 @@
+#ifndef SECURITIES_SCANNER_NOTIFIER_COMMAND_ROUTER_H
+#define SECURITIES_SCANNER_NOTIFIER_COMMAND_ROUTER_H
+
+#include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+// The whole text as a number, surrounding spaces aside. Floating point values
+// are plain decimals: no exponent, nan or inf.
+template<typename T>
+std::optional<T> parse_argument(std::string_view text) {
+    auto begin = text.find_first_not_of(' ');
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+
+    auto end = text.find_last_not_of(' ') + 1;
+    T value;
+    std::from_chars_result result;
+    if constexpr (std::is_floating_point_v<T>) {
+        result = std::from_chars(text.data() + begin, text.data() + end, value, std::chars_format::fixed);
+    } else {
+        result = std::from_chars(text.data() + begin, text.data() + end, value);
+    }
+    if (result.ec != std::errc {} || result.ptr != text.data() + end) {
+        return {};
+    }
+    if constexpr (std::is_floating_point_v<T>) {
+        if (!std::isfinite(value)) {
+            return {};
+        }
+    }
+
+    return value;
+}
+
+// Looks up the "/command" a bot message starts with, "@botname" suffix aside,
+// and posts its handler with the rest of the text to the thread pool. Every
+// chat has its own strand, so commands from a chat run in the order they came
+// while the long poll goes on receiving.
+class CommandRouter {
+    public:
+        using Handler = std::function<void (std::string_view args)>;
+
+        explicit CommandRouter(boost::asio::thread_pool& thread_pool);
+
+        CommandRouter(const CommandRouter& other) = delete;
+        CommandRouter& operator=(const CommandRouter& other) = delete;
+
+        // Routes are fixed once messages start coming
+        void route(const std::string& command, Handler handler);
+
+        // False when the text is not a routed command
+        bool dispatch(const int64_t chat_id, std::string_view text);
+    private:
+        using Strand = boost::asio::strand<boost::asio::thread_pool::executor_type>;
+
+        boost::asio::thread_pool& thread_pool;
+        std::map<std::string, Handler, std::less<>> routes;
+        std::mutex m;
+        std::unordered_map<int64_t, Strand> strands;
+
+        Strand& strand_for(const int64_t chat_id);
+};
+
+#endif // SECURITIES_SCANNER_NOTIFIER_COMMAND_ROUTER_H
@@ -0,0 +1,145 @@
+#include "message_format.h"
+
+#include <cmath>
+#include <stdexcept>
+
+const auto MARKDOWN_SPECIALS = []() {
+    std::array<bool, 256> table {};
+    for (unsigned char c : std::string_view {"_,*[]()~`>#+-=|{}.!\\"}) {
+        table[c] = true;
+    }
+    return table;
+}();
+
+std::string_view format_double(NumberBuffer& buffer, const double val) {
+    // The nudge keeps values such as 21.37, stored as 21.3699..., from losing a cent
+    auto cents = static_cast<int64_t>(std::trunc(val * 100 + std::copysign(1e-6, val)));
+    auto begin = buffer.data();
+    auto ptr = begin;
+    if (cents < 0) {
+        *ptr++ = '-';
+        cents = -cents;
+    }
+
+    ptr = std::to_chars(ptr, begin + buffer.size(), cents / 100).ptr;
+    *ptr++ = '\\';
+    *ptr++ = '.';
+    *ptr++ = static_cast<char>('0' + cents % 100 / 10);
+    *ptr++ = static_cast<char>('0' + cents % 10);
+    return std::string_view {begin, ptr};
+}
+
+const std::string format_date(const zoned_time& date) {
+    return std::format("{:%Y\\-%m\\-%d %H\\:%M\\:%S}", std::chrono::floor<std::chrono::seconds>(date.get_local_time()));
+}
+
+void append_sanitized(std::string& out, std::string_view text) {
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (MARKDOWN_SPECIALS[static_cast<unsigned char>(text[i])]) {
+            out.append(text.substr(start, i - start));
+            out.append("\\-");
+            start = i + 1;
+        }
+    }
+    out.append(text.substr(start));
+}
+
+MessageTemplate::MessageTemplate(const std::string& pattern, const size_t a_arity) :
+    arity {a_arity},
+    pieces {} {
+    std::string literal;
+    size_t next_field = 0;
+    bool automatic = false;
+    bool manual = false;
+    for (size_t i = 0; i < pattern.size(); i++) {
+        auto c = pattern[i];
+        if ((c == '{' || c == '}') && i + 1 < pattern.size() && pattern[i + 1] == c) {
+            literal += c;
+            i++;
+            continue;
+        }
+        if (c == '}') {
+            throw std::invalid_argument {"Unmatched '}' in template: " + pattern};
+        }
+        if (c != '{') {
+            literal += c;
+            continue;
+        }
+
+        auto close = pattern.find('}', i);
+        if (close == std::string::npos) {
+            throw std::invalid_argument {"Unmatched '{' in template: " + pattern};
+        }
+
+        auto id = std::string_view {pattern}.substr(i + 1, close - i - 1);
+        size_t field;
+        if (id.empty()) {
+            automatic = true;
+            field = next_field++;
+        } else {
+            auto result = std::from_chars(id.data(), id.data() + id.size(), field);
+            if (result.ec != std::errc {} || result.ptr != id.data() + id.size()) {
+                throw std::invalid_argument {"Unsupported field {" + std::string {id} + "} in template: " + pattern};
+            }
+            manual = true;
+        }
+
+        if (automatic && manual) {
+            throw std::invalid_argument {"Template mixes automatic and manual field numbers: " + pattern};
+        }
+        if (field >= arity) {
+            throw std::invalid_argument {"Template refers to argument " + std::to_string(field)
+                + " of " + std::to_string(arity) + ": " + pattern};
+        }
+
+        pieces.push_back(Piece { .literal = std::move(literal), .field = field });
+        literal.clear();
+        i = close;
+    }
+
+    if (!literal.empty()) {
+        pieces.push_back(Piece { .literal = std::move(literal), .field = NO_FIELD });
+    }
+}
+
+void MessageTemplate::render_to(std::string& out, std::initializer_list<std::string_view> args) const {
+    if (args.size() < arity) {
+        throw std::invalid_argument {"Not enough template arguments"};
+    }
+
+    for (auto& piece : pieces) {
+        out.append(piece.literal);
+        if (piece.field != NO_FIELD) {
+            out.append(std::data(args)[piece.field]);
+        }
+    }
+}
+
+std::string MessageTemplate::render(std::initializer_list<std::string_view> args) const {
+    std::string out;
+    render_to(out, args);
+    return out;
+}
+
+MessageTemplates::MessageTemplates(const TgBotConfig& config) :
+    bonds_stats {config.bonds_stats_template, 4},
+    price {config.price_template, 5},
+    stats {config.stats_template, 11} {};
+
+void append_price_line(std::string& out, const MessageTemplate& price_template, const BondYield& price) {
+    thread_local std::string name;
+    name.clear();
+    append_sanitized(name, price.name);
+
+    NumberBuffer ytm_buffer;
+    NumberBuffer dtm_buffer;
+    NumberBuffer price_buffer;
+    price_template.render_to(out, {
+        name,
+        price.isin,
+        format_double(ytm_buffer, price.ytm),
+        format_int(dtm_buffer, price.dtm),
+        format_double(price_buffer, price.price)
+    });
+}
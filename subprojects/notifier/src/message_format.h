@@ -0,0 +1,65 @@
+#ifndef SECURITIES_SCANNER_NOTIFIER_MESSAGE_FORMAT_H
+#define SECURITIES_SCANNER_NOTIFIER_MESSAGE_FORMAT_H
+
+#include <sscan/notifier.h>
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Telegram rejects longer messages
+const size_t MAX_MESSAGE_LENGTH = 4096;
+
+// Room for any 64-bit integer or a formatted double
+using NumberBuffer = std::array<char, 32>;
+
+template<std::integral T>
+std::string_view format_int(NumberBuffer& buffer, const T val) {
+    auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), val);
+    return std::string_view {buffer.data(), result.ptr};
+}
+
+// Two decimals, truncated, with an escaped point as MarkdownV2 expects
+std::string_view format_double(NumberBuffer& buffer, const double val);
+const std::string format_date(const zoned_time& date);
+
+// Replaces MarkdownV2 special characters with an escaped hyphen
+void append_sanitized(std::string& out, std::string_view text);
+
+// A template in std::format syntax, split into literals and fields once so that
+// rendering only appends. Fields are "{}" or "{N}" without format specs, the
+// arguments are preformatted text.
+class MessageTemplate {
+    public:
+        MessageTemplate(const std::string& pattern, const size_t arity);
+
+        void render_to(std::string& out, std::initializer_list<std::string_view> args) const;
+        std::string render(std::initializer_list<std::string_view> args) const;
+    private:
+        static const size_t NO_FIELD = static_cast<size_t>(-1);
+
+        // A literal followed by a field, if any
+        struct Piece {
+            std::string literal;
+            size_t field;
+        };
+
+        const size_t arity;
+        std::vector<Piece> pieces;
+};
+
+// The tgbot templates that take arguments, checked when the notifier is created
+struct MessageTemplates {
+    const MessageTemplate bonds_stats;
+    const MessageTemplate price;
+    const MessageTemplate stats;
+
+    explicit MessageTemplates(const TgBotConfig& config);
+};
+
+void append_price_line(std::string& out, const MessageTemplate& price_template, const BondYield& price);
+
+#endif // SECURITIES_SCANNER_NOTIFIER_MESSAGE_FORMAT_H
@@ -1,10 +1,14 @@
 #include <sscan/notifier.h>
+#include <sscan/metrics.h>
+#include "command_router.h"
+#include "message_format.h"
+#include "outbox.h"
 
 #include <boost/asio/post.hpp>
 #include <boost/log/trivial.hpp>
+#include <array>
+#include <cmath>
 #include <memory>
-#include <math.h>
-#include <regex>
 
 const auto PREVIEW_OPTIONS = std::make_shared<TgBot::LinkPreviewOptions>(
     TgBot::LinkPreviewOptions {
@@ -15,22 +19,6 @@ const auto PREVIEW_OPTIONS = std::make_shared<TgBot::LinkPreviewOptions>(
         .showAboveText = false});
 
 const auto PARSE_MODE = "MarkdownV2";
-const std::regex markdonwn_specials_pattern("[_\\,\\*\\[\\]\\(\\)\\~>\\#\\+\\-=\\|\\{\\}\\.\\!]");
-const std::regex ytm_pattern("\\/ytm (\\d+\\.\\d+)");
-const std::regex dtm_pattern("\\/dtm (\\d+)");
-const int MAX_MESSAGE_PRICES = 20;
-
-const std::string format_double(const double val) {
-    double int_part;
-    double fract_part = modf(val , &int_part);
-    int int_part_value = std::trunc(int_part);
-    int fract_part_value = std::trunc(fract_part * 100);
-    return std::vformat("{:d}\\.{:02d}", std::make_format_args(int_part_value, fract_part_value));
-}
-
-const std::string format_date(const zoned_time& date) {
-    return std::format("{:%Y\\-%m\\-%d %H\\:%M\\:%S}", std::chrono::floor<std::chrono::seconds>(date.get_local_time()));
-}
 
 const std::string get_localized_state(const WorkingState& state) {
     switch (state) {
@@ -47,88 +35,72 @@ const std::string get_localized_state(const WorkingState& state) {
     throw std::invalid_argument {"unknown state"};
 }
 
-const std::string sanitize_text(const std::string text) {
-    return std::regex_replace(text, markdonwn_specials_pattern, "\\-");
-}
-
 Notifier::Notifier(const Config& a_config, boost::asio::thread_pool& a_thread_pool) : 
     config {a_config},
     thread_pool {a_thread_pool},
-    tgbot {config.tgbot.token},
-    on_stats_requested_func {} {};
+    tgbot_client {},
+    tgbot {config.tgbot.token, tgbot_client, config.tgbot.api_url},
+    on_stats_requested_func {},
+    templates {std::make_unique<MessageTemplates>(config.tgbot)},
+    router {std::make_unique<CommandRouter>(thread_pool)},
+    outbox {std::make_unique<Outbox>(config.tgbot, templates->price, [this](const std::string& message) { deliver(message); })} {};
+
+Notifier::~Notifier() = default;
 
 void Notifier::start() {
+    router->route("/stats", [this](std::string_view) { handle_stats_message(); });
+    router->route("/ytm", [this](std::string_view args) { handle_ytm_message(args); });
+    router->route("/dtm", [this](std::string_view args) { handle_dtm_message(args); });
+    router->route("/reload", [this](std::string_view) { handle_reload_message(); });
+    router->route("/overtime", [this](std::string_view) { on_working_state_change_func(WorkingState::OVERTIME); });
+    router->route("/holiday", [this](std::string_view) { on_working_state_change_func(WorkingState::HOLIDAY); });
+
+    outbox->start();
     tgbot.getEvents().onAnyMessage([&](TgBot::Message::Ptr message) { handle_message(message); });
     boost::asio::post(thread_pool, [&]() { long_poll();});
 }
 
 void Notifier::handle_message(TgBot::Message::Ptr message) {
-    try {
-        if (message->text.starts_with("/stats")) {
-            handle_stats_message();
-        }
-        if (message->text.starts_with("/ytm")) {
-            handle_ytm_message(message);
-        }
-        if (message->text.starts_with("/dtm")) {
-            handle_dtm_message(message);
-        }
-        if (message->text.starts_with("/reload")) {
-            handle_reload_message();
-        }
-        if (message->text.starts_with("/overtime")) {
-            on_working_state_change_func(WorkingState::OVERTIME);
-        }
-        if (message->text.starts_with("/holiday")) {
-            on_working_state_change_func(WorkingState::HOLIDAY);
-        }
-    } catch (const std::exception& ex) {
-        BOOST_LOG_TRIVIAL(error) << "Error handling message: " << ex.what();
-    }
+    router->dispatch(message->chat ? message->chat->id : 0, message->text);
 }
 
 void Notifier::handle_stats_message() {
     auto stats = on_stats_requested_func();
-    auto message = std::vformat(config.tgbot.stats_template, std::make_format_args(
-        stats.total_bonds_loaded,
+    std::array<NumberBuffer, 8> numbers;
+    auto message = templates->stats.render({
+        format_int(numbers[0], stats.total_bonds_loaded),
         format_date(stats.last_bonds_loaded),
-        stats.total_prices_loaded,
+        format_int(numbers[1], stats.total_prices_loaded),
         format_date(stats.last_prices_loaded),
-        format_double(stats.min_ytm),
-        stats.min_dtm,
-        get_localized_state(stats.working_state)
-    ));
+        format_double(numbers[2], stats.min_ytm),
+        format_int(numbers[3], stats.min_dtm),
+        get_localized_state(stats.working_state),
+        format_int(numbers[4], stats.price_cycles),
+        format_int(numbers[5], stats.price_cycles_skipped),
+        format_int(numbers[6], stats.tick_batches),
+        format_int(numbers[7], stats.alerts_sent)
+    });
     send_message(message);
 }
 
-void Notifier::handle_ytm_message(TgBot::Message::Ptr message) {
-    std::smatch matches;
-    if (!std::regex_match(message->text, matches, ytm_pattern)) {
+void Notifier::handle_ytm_message(std::string_view args) {
+    auto ytm = parse_argument<double>(args);
+    if (!ytm.has_value() || !std::isfinite(ytm.value()) || ytm.value() < 0) {
         send_message(config.tgbot.parse_error_template);
         return;
     }
 
-    try {
-        double d = std::stod(matches[1]);
-        on_target_ytm_change_func(d);
-    } catch (const std::exception& e) {
-        send_message(config.tgbot.parse_error_template);
-    }
+    on_target_ytm_change_func(ytm.value());
 }
 
-void Notifier::handle_dtm_message(TgBot::Message::Ptr message) {
-    std::smatch matches;
-    if (!std::regex_match(message->text, matches, dtm_pattern)) {
+void Notifier::handle_dtm_message(std::string_view args) {
+    auto dtm = parse_argument<int>(args);
+    if (!dtm.has_value() || dtm.value() < 0) {
         send_message(config.tgbot.parse_error_template);
         return;
     }
 
-    try {
-        int d = std::stoi(matches[1]);
-        on_target_dtm_change_func(d);
-    } catch (const std::exception& e) {
-        send_message(config.tgbot.parse_error_template);
-    }
+    on_target_dtm_change_func(dtm.value());
 }
 
 void Notifier::handle_reload_message() {
@@ -176,29 +148,18 @@ void Notifier::send_working_time_error() {
 }
 
 void Notifier::send_bonds_update_stats(const BondsUpdateStats& stats) {
-    auto message = std::vformat(config.tgbot.bonds_stats_template, std::make_format_args(stats.total_bonds_loaded));
+    std::array<NumberBuffer, 4> numbers;
+    auto message = templates->bonds_stats.render({
+        format_int(numbers[0], stats.total_bonds_loaded),
+        format_int(numbers[1], stats.bonds_added),
+        format_int(numbers[2], stats.bonds_removed),
+        format_int(numbers[3], stats.bonds_updated)
+    });
     send_message(message);
 }
 
 void Notifier::send_price_update_stats(const PriceUpdateStats& stats) {
-    std::string message;
-    for (size_t i = 0; i < stats.new_prices.size(); i++) {
-        auto& price = stats.new_prices[i];
-        auto price_message = std::vformat(config.tgbot.price_template, std::make_format_args(
-            sanitize_text(price.name),
-            price.isin,
-            format_double(price.ytm),
-            price.dtm,
-            format_double(price.price)
-        ));
-        message += price_message;
-
-        if ((i > 0 && i % MAX_MESSAGE_PRICES == 0) || (i == stats.new_prices.size() - 1)) {
-            send_message(message);
-            message.clear();
-        }
-    }
-    
+    outbox->push_alerts(stats.new_prices);
 }
 
 void Notifier::on_stats_requested(const std::function<ScannerStats ()>& func) {
@@ -233,12 +194,28 @@ void Notifier::long_poll() {
 }
 
 void Notifier::send_message(const std::string& message) {
-    tgbot.getApi().sendMessage(
-        config.tgbot.chat_id,
-         message,
-         PREVIEW_OPTIONS,
-         nullptr,
-         nullptr,
-         PARSE_MODE
-    );
+    outbox->push_text(message);
+}
+
+void Notifier::deliver(const std::string& message) {
+    static auto& messages_total = metrics::Registry::shared().counter(
+        "sscan_notifier_messages_total", "Telegram messages sent by result", {"result"});
+    static auto& send_seconds = metrics::Registry::shared().histogram(
+        "sscan_notifier_send_seconds", "Telegram sendMessage latency").with({});
+
+    metrics::Timer timer {send_seconds};
+    try {
+        tgbot.getApi().sendMessage(
+            config.tgbot.chat_id,
+             message,
+             PREVIEW_OPTIONS,
+             nullptr,
+             nullptr,
+             PARSE_MODE
+        );
+    } catch (...) {
+        messages_total.with({"error"}).inc();
+        throw;
+    }
+    messages_total.with({"ok"}).inc();
 }
\ No newline at end of file
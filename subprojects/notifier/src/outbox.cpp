@@ -0,0 +1,210 @@
+#include "outbox.h"
+
+#include <boost/log/trivial.hpp>
+
+const int MAX_SEND_ATTEMPTS = 3;
+
+Notifier::Outbox::Outbox(const TgBotConfig& a_config, const MessageTemplate& a_price_template, Sender a_sender) :
+    config {a_config},
+    price_template {a_price_template},
+    sender {std::move(a_sender)},
+    chat_limiter {std::make_unique<http::RateLimiter>(config.chat_rps, 1, "telegram_chat")},
+    global_limiter {http::RateLimiter::shared("telegram", config.global_rps)},
+    stopped {false},
+    text_depth {metrics::Registry::shared()
+        .gauge("sscan_notifier_queue_depth", "Messages and alerts waiting to be sent", {"kind"})
+        .with({"text"})},
+    alert_depth {metrics::Registry::shared()
+        .gauge("sscan_notifier_queue_depth", "Messages and alerts waiting to be sent", {"kind"})
+        .with({"alert"})},
+    text_queue_seconds {metrics::Registry::shared()
+        .histogram("sscan_notifier_queue_seconds", "Time from reporting to sending", {"kind"})
+        .with({"text"})},
+    alert_queue_seconds {metrics::Registry::shared()
+        .histogram("sscan_notifier_queue_seconds", "Time from reporting to sending", {"kind"})
+        .with({"alert"})},
+    alerts_merged {metrics::Registry::shared()
+        .counter("sscan_notifier_alerts_merged_total", "Alerts that replaced a pending alert for the same bond")
+        .with({})},
+    dropped_total {metrics::Registry::shared()
+        .counter("sscan_notifier_dropped_total", "Messages and alerts dropped before sending", {"kind", "reason"})} {};
+
+Notifier::Outbox::~Outbox() {
+    stop();
+}
+
+void Notifier::Outbox::start() {
+    if (thread.joinable()) {
+        return;
+    }
+
+    thread = std::thread([this]() { run(); });
+}
+
+// Whatever is still pending is dropped
+void Notifier::Outbox::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopped = true;
+    }
+    not_empty.notify_all();
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void Notifier::Outbox::push_text(std::string text) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (texts.size() + alert_order.size() >= config.queue_size) {
+            if (alert_order.empty()) {
+                dropped_total.with({"text", "overflow"}).inc();
+                BOOST_LOG_TRIVIAL(warning) << "Notification queue is full, message dropped";
+                return;
+            }
+            drop_oldest_alert("overflow");
+        }
+
+        texts.push_back(Text { .text = std::move(text), .queued = clock::now() });
+        update_depth();
+    }
+    not_empty.notify_one();
+}
+
+void Notifier::Outbox::push_alerts(const std::vector<BondYield>& prices) {
+    {
+        std::lock_guard<std::mutex> lock(m);
+        auto now = clock::now();
+        for (auto& price : prices) {
+            auto alert_it = alerts.find(price.isin);
+            if (alert_it != alerts.end()) {
+                alert_it->second = Alert { .price = price, .queued = now };
+                alerts_merged.inc();
+                continue;
+            }
+
+            if (texts.size() + alert_order.size() >= config.queue_size) {
+                if (alert_order.empty()) {
+                    dropped_total.with({"alert", "overflow"}).inc();
+                    continue;
+                }
+                drop_oldest_alert("overflow");
+            }
+
+            alerts.emplace(price.isin, Alert { .price = price, .queued = now });
+            alert_order.push_back(price.isin);
+        }
+        update_depth();
+    }
+    not_empty.notify_one();
+}
+
+void Notifier::Outbox::run() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            not_empty.wait(lock, [&]() { return stopped || !texts.empty() || !alert_order.empty(); });
+            if (stopped) {
+                return;
+            }
+        }
+
+        // Alerts that arrive while waiting for the slot still make it into this message
+        chat_limiter->acquire();
+        global_limiter->acquire();
+
+        auto batch = next_batch();
+        if (batch.has_value()) {
+            send(batch.value());
+        }
+    }
+}
+
+std::optional<Notifier::Outbox::Batch> Notifier::Outbox::next_batch() {
+    std::lock_guard<std::mutex> lock(m);
+    if (!texts.empty()) {
+        auto text = std::move(texts.front());
+        texts.pop_front();
+        update_depth();
+        return Batch { .alerts = false, .message = std::move(text.text), .queued = {text.queued} };
+    }
+
+    auto now = clock::now();
+    auto max_age = std::chrono::milliseconds(config.alert_max_age_ms);
+    auto batch = Batch { .alerts = true, .message = {}, .queued = {} };
+    while (!alert_order.empty()) {
+        auto alert_it = alerts.find(alert_order.front());
+        if (now - alert_it->second.queued > max_age) {
+            dropped_total.with({"alert", "stale"}).inc();
+            alerts.erase(alert_it);
+            alert_order.pop_front();
+            continue;
+        }
+
+        auto size = batch.message.size();
+        append_price_line(batch.message, price_template, alert_it->second.price);
+        if (batch.message.size() > MAX_MESSAGE_LENGTH) {
+            batch.message.resize(size);
+            if (size > 0) {
+                break;
+            }
+
+            // Telegram would reject it on every attempt, and cutting it could
+            // break the MarkdownV2 escaping
+            BOOST_LOG_TRIVIAL(warning) << "Alert for " << alert_it->first << " is longer than a message, dropped";
+            dropped_total.with({"alert", "oversize"}).inc();
+            alerts.erase(alert_it);
+            alert_order.pop_front();
+            continue;
+        }
+
+        batch.queued.push_back(alert_it->second.queued);
+        alerts.erase(alert_it);
+        alert_order.pop_front();
+    }
+    update_depth();
+
+    if (batch.message.empty()) {
+        return {};
+    }
+
+    return batch;
+}
+
+void Notifier::Outbox::send(const Batch& batch) {
+    for (int attempt = 1; ; attempt++) {
+        try {
+            sender(batch.message);
+            break;
+        } catch (const std::exception& ex) {
+            if (attempt == MAX_SEND_ATTEMPTS) {
+                dropped_total.with({batch.alerts ? "alert" : "text", "error"}).inc(batch.queued.size());
+                BOOST_LOG_TRIVIAL(error) << "Error sending message: " << ex.what();
+                return;
+            }
+
+            BOOST_LOG_TRIVIAL(warning) << "Error sending message, retrying: " << ex.what();
+            std::this_thread::sleep_for(std::chrono::seconds(attempt));
+            chat_limiter->acquire();
+            global_limiter->acquire();
+        }
+    }
+
+    auto now = clock::now();
+    auto& queue_seconds = batch.alerts ? alert_queue_seconds : text_queue_seconds;
+    for (auto& queued : batch.queued) {
+        queue_seconds.observe(now - queued);
+    }
+}
+
+void Notifier::Outbox::drop_oldest_alert(const std::string& reason) {
+    alerts.erase(alert_order.front());
+    alert_order.pop_front();
+    dropped_total.with({"alert", reason}).inc();
+}
+
+void Notifier::Outbox::update_depth() {
+    text_depth.set(texts.size());
+    alert_depth.set(alert_order.size());
+}
@@ -0,0 +1,91 @@
+#ifndef SECURITIES_SCANNER_NOTIFIER_OUTBOX_H
+#define SECURITIES_SCANNER_NOTIFIER_OUTBOX_H
+
+#include "message_format.h"
+
+#include <sscan/notifier.h>
+#include <sscan/metrics.h>
+#include <sscan/rate_limiter.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Outgoing messages wait here for a dedicated sender thread, so reporting never
+// blocks on the Telegram API. Every message takes a slot from the per-chat and
+// the global rate limiter first, and only then is built from what is pending:
+// the oldest text message on its own, otherwise all pending price alerts packed
+// into as few messages as fit. A newer alert for a bond replaces the pending one,
+// alerts older than alert-max-age-ms or longer than a message are dropped, and
+// when the queue is full the oldest alert makes room.
+class Notifier::Outbox {
+    public:
+        using Sender = std::function<void (const std::string& message)>;
+        using clock = std::chrono::steady_clock;
+
+        Outbox(const TgBotConfig& config, const MessageTemplate& price_template, Sender sender);
+        ~Outbox();
+
+        Outbox(const Outbox& other) = delete;
+        Outbox& operator=(const Outbox& other) = delete;
+
+        void start();
+        void stop();
+
+        void push_text(std::string text);
+        void push_alerts(const std::vector<BondYield>& prices);
+    private:
+        struct Text {
+            std::string text;
+            clock::time_point queued;
+        };
+
+        struct Alert {
+            BondYield price;
+            clock::time_point queued;
+        };
+
+        // One Telegram message and the enqueue times of what it carries
+        struct Batch {
+            bool alerts;
+            std::string message;
+            std::vector<clock::time_point> queued;
+        };
+
+        const TgBotConfig& config;
+        const MessageTemplate& price_template;
+        const Sender sender;
+        const std::unique_ptr<http::RateLimiter> chat_limiter;
+        const std::shared_ptr<http::RateLimiter> global_limiter;
+
+        std::mutex m;
+        std::condition_variable not_empty;
+        bool stopped;
+        std::deque<Text> texts;
+        // Alerts by ISIN, sent in the order the bonds were first reported
+        std::unordered_map<std::string, Alert> alerts;
+        std::deque<std::string> alert_order;
+        std::thread thread;
+
+        metrics::Gauge& text_depth;
+        metrics::Gauge& alert_depth;
+        metrics::Histogram& text_queue_seconds;
+        metrics::Histogram& alert_queue_seconds;
+        metrics::Counter& alerts_merged;
+        metrics::Family<metrics::Counter>& dropped_total;
+
+        void run();
+        std::optional<Batch> next_batch();
+        void send(const Batch& batch);
+        void drop_oldest_alert(const std::string& reason);
+        void update_depth();
+};
+
+#endif // SECURITIES_SCANNER_NOTIFIER_OUTBOX_H
@@ -6,9 +6,17 @@
 #include <sscan/price_loader.h>
 #include <sscan/notifier.h>
 #include <boost/asio/thread_pool.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <semaphore>
 #include <shared_mutex>
 #include <chrono>
+#include <vector>
+
+struct BondTable;
+struct PriceCeilings;
 
 class Scanner {
     public:
@@ -25,27 +33,57 @@ class Scanner {
         Scanner& operator=(const Scanner& other) = delete;
 
         void start();
-        void process();
     private:
 
         struct BlacklistParams;
         class Storage;
+        class Scheduler;
 
         using zoned_time = std::chrono::zoned_time<std::chrono::_V2::system_clock::duration, const std::chrono::time_zone*>;
 
         const Config& config;
         const std::chrono::time_zone* tz;
         std::unique_ptr<Storage> storage;
+        std::unique_ptr<Scheduler> scheduler;
         PriceLoader& price_loader;
         Notifier& notifier;
         boost::asio::thread_pool& thread_pool;
         
-        ScannerStats stats;
-        std::counting_semaphore<1> bonds_sem;
+        // Immutable snapshots: readers load without locking, writers copy under stats_m
+        std::mutex stats_m;
+        std::atomic<std::shared_ptr<const ScannerStats>> stats;
         std::counting_semaphore<1> price_sem;
+        size_t state_task;
+        size_t bonds_task;
+        size_t price_task;
+
+        std::mutex ticks_m;
+        PriceMap ticks;
+        std::atomic<bool> ticks_scheduled;
+        std::atomic<u_int64_t> polled_generation;
+
+        // Evaluation state by table position, guarded by price_sem
+        std::shared_ptr<const BondTable> evaluated_table;
+        std::vector<long> last_prices;
+        std::atomic<bool> reevaluate_all;
 
+        std::shared_ptr<const ScannerStats> get_stats();
+        void update_stats(const std::function<void (ScannerStats& stats)>& update);
+        void update_working_state();
+        void refresh_bonds();
+        void poll_prices();
+        void wake_all();
         bool is_bonds_outdated();
+        bool is_scanning();
+        void subscribe_prices();
+        void on_price_ticks(PriceMap&& prices);
+        void process_ticks();
         PriceUpdateStats update_prices();
+        PriceUpdateStats update_prices(PriceMap&& prices);
+        PriceUpdateStats evaluate_prices(
+            const std::string& feed,
+            const std::shared_ptr<const PriceCeilings>& ceilings,
+            const std::function<void (const PricePointHandler&)>& source);
         void temp_blacklist_bonds(const PriceUpdateStats& stats);
 };
 
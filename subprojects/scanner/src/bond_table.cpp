@@ -0,0 +1,64 @@
+#include "bond_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::shared_ptr<const BondTable> make_bond_table(std::shared_ptr<const UidsMap<BondInfo>> bonds) {
+    auto table = std::make_shared<BondTable>();
+    auto size = bonds->size();
+
+    auto uids = std::vector<boost::uuids::uuid>();
+    uids.reserve(size);
+    table->rows.reserve(size);
+    table->nominal.reserve(size);
+    table->cash_flow.reserve(size);
+    table->accured_interest.reserve(size);
+    table->dtm.reserve(size);
+
+    for (auto& entry : *bonds) {
+        auto& bond = entry.second;
+        uids.push_back(bond.uid);
+        table->rows.push_back(&bond);
+        table->nominal.push_back(bond.nominal);
+        table->cash_flow.push_back(bond.cash_flow);
+        table->accured_interest.push_back(bond.accured_interest);
+        table->dtm.push_back(bond.dtm);
+    }
+
+    table->ids = InstrumentIds(std::move(uids));
+    table->bonds = std::move(bonds);
+    return table;
+}
+
+// Solves calc_ytm(price) == min_ytm for price:
+// price = (cash_flow / (1 + min_ytm * dtm / 36500) - accured_interest) * 10000 / nominal
+long price_ceiling(const BondTable& table, size_t position, double min_ytm, int min_dtm) {
+    auto dtm = table.dtm[position];
+    auto nominal = table.nominal[position];
+    if (dtm < min_dtm || nominal <= 0) {
+        return -1;
+    }
+
+    auto growth = 1 + min_ytm * dtm / 36500;
+    auto price = (table.cash_flow[position] / growth - table.accured_interest[position]) * 10000 / nominal;
+    if (growth <= 0 || !std::isfinite(price) || price >= std::numeric_limits<long>::max() / 2) {
+        return std::numeric_limits<long>::max();
+    }
+
+    // One unit of slack absorbs rounding differences with calc_ytm
+    return std::max(static_cast<long>(std::floor(price)) + 1, -1L);
+}
+
+std::shared_ptr<const PriceCeilings> make_price_ceilings(std::shared_ptr<const BondTable> table, double min_ytm, int min_dtm) {
+    auto ceilings = std::make_shared<PriceCeilings>();
+    ceilings->min_ytm = min_ytm;
+    ceilings->min_dtm = min_dtm;
+    ceilings->ceiling.reserve(table->size());
+    for (size_t position = 0; position < table->size(); position++) {
+        ceilings->ceiling.push_back(price_ceiling(*table, position, min_ytm, min_dtm));
+    }
+
+    ceilings->table = std::move(table);
+    return ceilings;
+}
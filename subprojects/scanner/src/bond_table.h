@@ -0,0 +1,53 @@
+#ifndef SECURITIES_SCANNER_SCANNER_BOND_TABLE_H
+#define SECURITIES_SCANNER_SCANNER_BOND_TABLE_H
+
+#include <sscan/bond_info.h>
+#include <sscan/instrument_ids.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <boost/container_hash/hash.hpp>
+
+template<typename V>
+using UidsMap = std::unordered_map<boost::uuids::uuid, V, boost::hash<boost::uuids::uuid>>;
+using UidSet = std::vector<boost::uuids::uuid>;
+
+// Simple annual yield to maturity in percent for a price in broker units.
+inline double calc_ytm(double price, double nominal, double cash_flow, double accured_interest, double dtm) {
+    auto value = price / 10000.0 * nominal;
+    return (cash_flow / (value + accured_interest) - 1) * 365.0 / dtm * 100;
+}
+
+// Column layout of a published universe for the price pipeline. Positions are
+// the interned instrument ids, index every column and are fixed for the
+// lifetime of the table.
+struct BondTable {
+    std::shared_ptr<const UidsMap<BondInfo>> bonds;
+    std::vector<const BondInfo*> rows;
+    InstrumentIds ids;
+
+    std::vector<double> nominal;
+    std::vector<double> cash_flow;
+    std::vector<double> accured_interest;
+    std::vector<double> dtm;
+
+    size_t size() const {
+        return rows.size();
+    }
+};
+
+// Highest price in broker units at which each bond can still reach min_ytm.
+// Yield falls as price grows, so any price above the ceiling is rejected without
+// computing it. Ceilings round up; prices at or below them still need calc_ytm.
+// Bonds with less than min_dtm days to maturity get -1.
+struct PriceCeilings {
+    std::shared_ptr<const BondTable> table;
+    double min_ytm;
+    int min_dtm;
+    std::vector<long> ceiling;
+};
+
+std::shared_ptr<const BondTable> make_bond_table(std::shared_ptr<const UidsMap<BondInfo>> bonds);
+std::shared_ptr<const PriceCeilings> make_price_ceilings(std::shared_ptr<const BondTable> table, double min_ytm, int min_dtm);
+
+#endif // SECURITIES_SCANNER_SCANNER_BOND_TABLE_H
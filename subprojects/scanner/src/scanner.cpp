@@ -1,8 +1,11 @@
 #include <sscan/scanner.h>
+#include <sscan/metrics.h>
+#include <sscan/trace.h>
 #include <iostream>
 #include <boost/asio/post.hpp>
 #include <boost/log/trivial.hpp>
 #include "storage.h"
+#include "scheduler.h"
 
 constexpr int BONDS_UPDATE_INTERVAL_HRS = 24;
 
@@ -26,6 +29,12 @@ bool is_working_hours(const zoned_time& now, const std::chrono::time_zone* tz) {
     return true;
 }
 
+zoned_time bonds_loading_day(const std::chrono::system_clock::time_point& loaded, const std::chrono::time_zone* tz) {
+    std::chrono::zoned_time zt(tz, loaded);
+    auto local_day = std::chrono::floor<std::chrono::days>(zt.get_local_time());
+    return std::chrono::zoned_time(tz, local_day + std::chrono::hours(8));
+}
+
 Scanner::~Scanner() = default;
 
 Scanner::Scanner(
@@ -36,39 +45,82 @@ Scanner::Scanner(
     boost::asio::thread_pool& a_pool) 
     : config { a_config },
     tz { std::chrono::locate_zone(a_config.broker.timezone) },
-    storage { new Storage(a_bonds_loader, tz) },
+    storage { new Storage(a_bonds_loader, tz, a_config.storage) },
+    scheduler { new Scheduler(a_pool) },
     price_loader { a_price_loader },
     notifier { a_notifier },
     thread_pool { a_pool },
-    stats { },
-    bonds_sem {1},
-    price_sem {1} {}
+    stats_m {},
+    stats {std::make_shared<const ScannerStats>()},
+    price_sem {1},
+    state_task {0},
+    bonds_task {0},
+    price_task {0},
+    ticks_m {},
+    ticks {},
+    ticks_scheduled {false},
+    polled_generation {0},
+    evaluated_table {},
+    last_prices {},
+    reevaluate_all {true} {}
 
 void Scanner::start() {
 
-    stats.working_state = WorkingState::IDLE;
+    update_stats([](ScannerStats& stats) { stats.working_state = WorkingState::IDLE; });
+
+    auto snapshot_created = storage->restore();
+    if (snapshot_created.has_value()) {
+        auto total_bonds = storage->get_bonds()->size();
+        update_stats([&](ScannerStats& stats) {
+            stats.last_bonds_loaded = bonds_loading_day(snapshot_created.value(), tz);
+            stats.total_bonds_loaded = total_bonds;
+        });
+        subscribe_prices();
+    }
+
+    state_task = scheduler->add(
+        "state",
+        std::chrono::milliseconds(config.scanner.state_interval_ms),
+        Scheduler::Policy::SKIP,
+        [this]() { update_working_state(); });
+    bonds_task = scheduler->add(
+        "bonds",
+        std::chrono::milliseconds(config.scanner.bonds_interval_ms),
+        Scheduler::Policy::SKIP,
+        [this]() { refresh_bonds(); });
+    price_task = scheduler->add(
+        "prices",
+        std::chrono::milliseconds(config.scanner.price_interval_ms),
+        Scheduler::parse_policy(config.scanner.price_policy),
+        [this]() { poll_prices(); });
 
     notifier.on_stats_requested([&]() { 
-        return stats;
+        return *get_stats();
     });
 
     notifier.on_target_ytm_change([&](double ytm) {
         storage->set_min_ytm(ytm);
         storage->reset_blacklist();
-        stats.min_ytm = ytm;
+        update_stats([&](ScannerStats& stats) { stats.min_ytm = ytm; });
+        reevaluate_all = true;
         notifier.send_value_set();
+        scheduler->wake(price_task);
     });
 
     notifier.on_target_dtm_change([&](int dtm) {
         storage->set_min_dtm(dtm);
         storage->reset_blacklist();
-        stats.min_dtm = dtm;
+        update_stats([&](ScannerStats& stats) { stats.min_dtm = dtm; });
+        reevaluate_all = true;
         notifier.send_value_set();
+        scheduler->wake(price_task);
     });
 
     notifier.on_reload([&]() {
         storage->reset_blacklist();
+        reevaluate_all = true;
         notifier.send_reloaded();
+        scheduler->wake(price_task);
     });
 
     notifier.on_working_state_change([&](WorkingState state) {
@@ -78,14 +130,15 @@ void Scanner::start() {
             return;
         }
 
-        auto current_state = stats.working_state;
+        auto current_state = get_stats()->working_state;
 
         if (state == WorkingState::OVERTIME) {
             if (current_state == WorkingState::WORKING || current_state == WorkingState::OVERTIME) {
                 notifier.send_overtime_fail();
             } else {
-                stats.working_state = state;
+                update_stats([&](ScannerStats& stats) { stats.working_state = state; });
                 notifier.send_overtime_success();
+                wake_all();
             }
         }
 
@@ -93,156 +146,382 @@ void Scanner::start() {
             if (current_state == WorkingState::HOLIDAY) {
                 notifier.send_holiday_fail();
             } else {
-                stats.working_state = state;
+                update_stats([&](ScannerStats& stats) { stats.working_state = state; });
                 notifier.send_holiday_success();
+                wake_all();
             }
         }
     });
 
-    while (true) {
-        try {
-            process();
-        } catch (const std::exception& ex) {
-            BOOST_LOG_TRIVIAL(error) << ex.what();
-        }
-        std::this_thread::sleep_for(std::chrono::seconds(10));
-    }
+    scheduler->run();
 }
 
-void Scanner::process() {
-    stats.min_ytm = storage->get_min_ytm();
-    stats.min_dtm = storage->get_min_dtm();
+std::shared_ptr<const ScannerStats> Scanner::get_stats() {
+    return stats.load();
+}
+
+void Scanner::update_stats(const std::function<void (ScannerStats& stats)>& update) {
+    std::lock_guard<std::mutex> lock(stats_m);
+    auto next = std::make_shared<ScannerStats>(*stats.load());
+    update(*next);
+    stats.store(std::move(next));
+}
+
+void Scanner::update_working_state() {
+    auto min_ytm = storage->get_min_ytm();
+    auto min_dtm = storage->get_min_dtm();
+    update_stats([&](ScannerStats& stats) {
+        stats.min_ytm = min_ytm;
+        stats.min_dtm = min_dtm;
+    });
+    if (storage->expire_blacklist()) {
+        reevaluate_all = true;
+    }
 
     auto now = std::chrono::zoned_time(tz, std::chrono::system_clock::now());
-    auto working_hours = is_working_hours(now, tz);
+    auto working_hours = config.scanner.ignore_working_hours || is_working_hours(now, tz);
+    auto working_state = get_stats()->working_state;
 
     if (!working_hours) {
-        if (stats.working_state == WorkingState::WORKING || stats.working_state == WorkingState::OVERTIME) {
+        if (working_state == WorkingState::WORKING || working_state == WorkingState::OVERTIME) {
             try {
                 notifier.send_farewell();
             } catch (const std::exception& ex) {
                 BOOST_LOG_TRIVIAL(error) << ex.what();
             }
         }
-        stats.working_state = WorkingState::IDLE;
+        update_stats([](ScannerStats& stats) { stats.working_state = WorkingState::IDLE; });
         return;
     }
 
-    if (stats.working_state == WorkingState::HOLIDAY) {
+    if (working_state == WorkingState::HOLIDAY) {
         return;
     }
 
-    auto weekend = is_weekend(now);
-    if (stats.working_state != WorkingState::OVERTIME && weekend) {
+    auto weekend = !config.scanner.ignore_working_hours && is_weekend(now);
+    if (working_state != WorkingState::OVERTIME && weekend) {
         return;
     }
 
-    if (stats.working_state == WorkingState::IDLE) {
+    if (working_state == WorkingState::IDLE) {
         try {
             notifier.send_greeting();
         } catch (const std::exception& ex) {
             BOOST_LOG_TRIVIAL(error) << ex.what();
         }
-        stats.working_state = WorkingState::WORKING;
+        update_stats([](ScannerStats& stats) { stats.working_state = WorkingState::WORKING; });
+        reevaluate_all = true;
+        scheduler->wake(bonds_task);
+        scheduler->wake(price_task);
     }
+}
 
-    bool bonds_outdated = is_bonds_outdated() ;
-    if (bonds_outdated && bonds_sem.try_acquire()) {
-        boost::asio::post(thread_pool, [&]() {
-            try {
-                auto bonds_loaded = storage->load();
-                notifier.send_bonds_update_stats(BondsUpdateStats { bonds_loaded });
+void Scanner::refresh_bonds() {
+    auto state = get_stats()->working_state;
+    if ((state != WorkingState::WORKING && state != WorkingState::OVERTIME) || !is_bonds_outdated()) {
+        return;
+    }
 
-                std::chrono::zoned_time zt(tz, std::chrono::system_clock::now());
-                auto local_day = std::chrono::floor<std::chrono::days>(zt.get_local_time());
-                stats.last_bonds_loaded = std::chrono::zoned_time(tz, local_day + std::chrono::hours(8));
-                stats.total_bonds_loaded = bonds_loaded;
-            } catch (const std::exception& ex) {
-                BOOST_LOG_TRIVIAL(error) << "Error updating bonds: " << ex.what();
-            }
-            
-            bonds_sem.release();
+    try {
+        auto delta = storage->refresh();
+        notifier.send_bonds_update_stats(BondsUpdateStats { 
+            .total_bonds_loaded = delta.total,
+            .bonds_added = delta.added.size(),
+            .bonds_removed = delta.removed.size(),
+            .bonds_updated = delta.updated.size()
         });
+
+        update_stats([&](ScannerStats& stats) {
+            stats.last_bonds_loaded = bonds_loading_day(std::chrono::system_clock::now(), tz);
+            stats.total_bonds_loaded = delta.total;
+        });
+        // Bonds kept across a refresh are aged, so every yield moves
+        reevaluate_all = true;
+        subscribe_prices();
+        scheduler->wake(price_task);
+    } catch (const std::exception& ex) {
+        BOOST_LOG_TRIVIAL(error) << "Error updating bonds: " << ex.what();
     }
+}
 
-    if (!bonds_outdated && price_sem.try_acquire()) {
-        boost::asio::post(thread_pool, [&]() {
-            try {
-                auto prices = update_prices();
-                if (prices.new_prices.size() != 0) {
-                    notifier.send_price_update_stats(prices);
-                }
-                temp_blacklist_bonds(prices);
-                stats.last_prices_loaded = std::chrono::zoned_time(tz, std::chrono::system_clock::now());
-                stats.total_prices_loaded = prices.total_prices;
-            } catch (const std::exception& ex) {
-                BOOST_LOG_TRIVIAL(error) << "Error updating prices: " << ex.what();
-            }
+void Scanner::poll_prices() {
+    // With a live price stream only ticked instruments are evaluated, and the
+    // whole universe is polled once after every (re)subscription to catch up.
+    auto stream_generation = price_loader.get_stream_generation();
+    bool poll_due = !price_loader.is_streaming() || stream_generation != polled_generation;
 
-            price_sem.release();
+    if (!is_scanning() || !poll_due) {
+        return;
+    }
+
+    price_sem.acquire();
+    try {
+        trace::Span span {"poll_prices"};
+        auto prices = update_prices();
+        polled_generation = stream_generation;
+        if (prices.new_prices.size() != 0) {
+            trace::Span notify_span {"notify"};
+            notifier.send_price_update_stats(prices);
+        }
+        temp_blacklist_bonds(prices);
+        update_stats([&](ScannerStats& stats) {
+            stats.last_prices_loaded = std::chrono::zoned_time(tz, std::chrono::system_clock::now());
+            stats.total_prices_loaded = prices.total_prices;
+            stats.alerts_sent += prices.new_prices.size();
         });
+    } catch (const std::exception& ex) {
+        BOOST_LOG_TRIVIAL(error) << "Error updating prices: " << ex.what();
     }
+    price_sem.release();
+
+    auto skipped = scheduler->get_stats(price_task).skipped;
+    update_stats([&](ScannerStats& stats) {
+        stats.price_cycles++;
+        stats.price_cycles_skipped = skipped;
+    });
+}
+
+void Scanner::wake_all() {
+    reevaluate_all = true;
+    scheduler->wake(state_task);
+    scheduler->wake(bonds_task);
+    scheduler->wake(price_task);
 }
 
 bool Scanner::is_bonds_outdated() {
     auto now = std::chrono::zoned_time(tz, std::chrono::system_clock::now());
     return std::chrono::duration_cast<std::chrono::hours>(
-        now.get_sys_time() - stats.last_bonds_loaded.get_sys_time()).count() >= BONDS_UPDATE_INTERVAL_HRS;
+        now.get_sys_time() - get_stats()->last_bonds_loaded.get_sys_time()).count() >= BONDS_UPDATE_INTERVAL_HRS;
+}
+
+bool Scanner::is_scanning() {
+    auto state = get_stats()->working_state;
+    return (state == WorkingState::WORKING || state == WorkingState::OVERTIME) && storage->get_bonds();
+}
+
+void Scanner::subscribe_prices() {
+    auto bonds = storage->get_bonds();
+    if (!bonds) {
+        return;
+    }
+
+    auto uids = UidSet();
+    uids.reserve(bonds->size());
+    for (auto& entry : *bonds) {
+        uids.push_back(entry.first);
+    }
+
+    price_loader.subscribe(uids, [this](PriceMap&& prices) {
+        on_price_ticks(std::move(prices));
+    });
+}
+
+// Runs on the stream's thread: ticks are coalesced until the pool picks them up.
+void Scanner::on_price_ticks(PriceMap&& prices) {
+    {
+        std::lock_guard<std::mutex> lock(ticks_m);
+        for (auto& entry : prices) {
+            ticks.insert_or_assign(entry.first, entry.second);
+        }
+    }
+
+    if (!ticks_scheduled.exchange(true)) {
+        boost::asio::post(thread_pool, [this]() { process_ticks(); });
+    }
+}
+
+void Scanner::process_ticks() {
+    ticks_scheduled = false;
+
+    auto prices = PriceMap();
+    {
+        std::lock_guard<std::mutex> lock(ticks_m);
+        prices.swap(ticks);
+    }
+
+    if (prices.empty() || !is_scanning()) {
+        return;
+    }
+
+    price_sem.acquire();
+    try {
+        trace::Span span {"process_ticks"};
+        auto result = update_prices(std::move(prices));
+        if (result.new_prices.size() != 0) {
+            trace::Span notify_span {"notify"};
+            notifier.send_price_update_stats(result);
+        }
+        temp_blacklist_bonds(result);
+        update_stats([&](ScannerStats& stats) {
+            stats.last_prices_loaded = std::chrono::zoned_time(tz, std::chrono::system_clock::now());
+            stats.tick_batches++;
+            stats.alerts_sent += result.new_prices.size();
+        });
+    } catch (const std::exception& ex) {
+        BOOST_LOG_TRIVIAL(error) << "Error updating streamed prices: " << ex.what();
+    }
+    price_sem.release();
 }
 
 PriceUpdateStats Scanner::update_prices() {
-    auto prices = PriceMap{};
-    auto new_prices = std::vector<BondYield>();
     BOOST_LOG_TRIVIAL(debug) << "Updating prices";
-    try {
-        auto bonds = storage->get_bonds();
-        auto min_ytm = stats.min_ytm;
-        auto min_dtm = stats.min_dtm;
-
-        auto uids = UidSet();
-        uids.reserve(bonds->size());
-        for (auto& entry : *bonds) {
-            auto& bond = entry.second;
-            if (bond.dtm >= min_dtm) {
-                uids.push_back(entry.first);
+
+    // Bonds without a positive ceiling cannot qualify at any price
+    auto ids = std::vector<u_int32_t>();
+    auto ceilings = storage->get_ceilings();
+    auto& table = *ceilings->table;
+
+    {
+        trace::Span span {"collect_ids"};
+        ids.reserve(table.size());
+        for (u_int32_t position = 0; position < table.size(); position++) {
+            if (ceilings->ceiling[position] > 0) {
+                ids.push_back(position);
             }
         }
+    }
 
-        prices = price_loader.load(uids);
+    return evaluate_prices("poll", ceilings, [&](const PricePointHandler& handler) {
+        price_loader.load(table.ids, ids, handler);
+    });
+}
+
+// Streamed ticks come keyed by uid, this is where they are interned
+PriceUpdateStats Scanner::update_prices(PriceMap&& prices) {
+    auto ceilings = storage->get_ceilings();
+    auto& table = *ceilings->table;
 
-        BOOST_LOG_TRIVIAL(debug) << "Total prices: " << std::to_string(prices.size());
+    auto points = PricePoints();
+    {
+        trace::Span span {"collect_ids"};
+        points.reserve(prices.size());
         for (auto& entry : prices) {
-            auto bond_it = bonds->find(entry.first);
-            if (bond_it == bonds->end()) {
-                continue;
+            auto id = table.ids.find(entry.first);
+            if (id != InstrumentIds::NONE) {
+                points.push_back(PricePoint { .id = id, .price = entry.second });
             }
+        }
+    }
 
-            auto& bond = bond_it->second;
-            auto price = entry.second / 10000.0 * bond.nominal;
-            auto ytm = (bond.cash_flow / (price + bond.accured_interest) - 1) * 365.0 / bond.dtm * 100;
-
-            if (ytm < min_ytm) {
-                continue;
-            }
+    return evaluate_prices("stream", ceilings, [&](const PricePointHandler& handler) {
+        handler(std::move(points));
+    });
+}
 
-            auto blacklisted_params = storage->get_blacklisted(bond.uid);
-            if (blacklisted_params.has_value() && ytm - blacklisted_params.value().max_ytm < 1) {
-                continue;
-            }
+PriceUpdateStats Scanner::evaluate_prices(
+    const std::string& feed,
+    const std::shared_ptr<const PriceCeilings>& ceilings,
+    const std::function<void (const PricePointHandler&)>& source) {
+
+    auto& registry = metrics::Registry::shared();
+    static auto& phase_seconds = registry.histogram(
+        "sscan_price_phase_seconds", "Duration of price evaluation phases", {"source", "phase"});
+    static auto& prices_total = registry.counter(
+        "sscan_prices_total", "Prices received", {"source"});
+    static auto& changed_total = registry.counter(
+        "sscan_prices_changed_total", "Prices that differ from the previous cycle", {"source"});
+    static auto& candidates_total = registry.counter(
+        "sscan_price_candidates_total", "Prices that passed the yield checks and went to the order book", {"source"});
+    static auto& alerts_total = registry.counter(
+        "sscan_alerts_total", "Bonds reported to the chat", {"source"});
+
+    metrics::Timer total_timer {phase_seconds.with({feed, "total"})};
+    u_int64_t total_prices = 0;
+    auto new_prices = std::vector<BondYield>();
+    try {
+        auto& table = *ceilings->table;
+        auto& ceiling = ceilings->ceiling;
+        auto min_ytm = ceilings->min_ytm;
+        auto blacklist = storage->get_blacklist();
+
+        struct Candidate {
+            const BondInfo& bond;
+            u_int32_t position;
+            std::optional<double> blacklisted_ytm;
+        };
+        auto candidates = std::vector<Candidate>();
+
+        if (reevaluate_all.exchange(false) || ceilings->table != evaluated_table) {
+            evaluated_table = ceilings->table;
+            last_prices.assign(table.size(), 0);
+        }
 
-            auto book_price = price_loader.load_book_price(bond.uid);
+        u_int64_t changed_prices = 0;
+        auto prices_started = std::chrono::steady_clock::now();
+        // A failed batch leaves its last prices untouched, so the candidates
+        // of the batches that did load still go to the order book
+        try {
+            source([&](PricePoints&& prices) {
+                trace::Span span {"evaluate"};
+                total_prices += prices.size();
+                for (auto& point : prices) {
+                    // An unchanged price gives the same verdict as in the previous cycle
+                    auto position = point.id;
+                    auto price = point.price;
+                    if (last_prices[position] == price) {
+                        continue;
+                    }
+                    last_prices[position] = price;
+                    changed_prices++;
+
+                    if (price <= 0 || price > ceiling[position]) {
+                        continue;
+                    }
+
+                    auto ytm = calc_ytm(price, table.nominal[position], table.cash_flow[position],
+                        table.accured_interest[position], table.dtm[position]);
+                    if (ytm < min_ytm) {
+                        continue;
+                    }
+
+                    auto blacklisted_ytm = blacklist->get_max_ytm(table, position);
+                    if (blacklisted_ytm.has_value() && ytm - blacklisted_ytm.value() < 1) {
+                        continue;
+                    }
+
+                    candidates.push_back(Candidate { *table.rows[position], position, blacklisted_ytm });
+                }
+            });
+        } catch (const std::exception& ex) {
+            BOOST_LOG_TRIVIAL(error) << "Error loading prices: " << ex.what();
+        }
+        phase_seconds.with({feed, "prices"}).observe(std::chrono::steady_clock::now() - prices_started);
+        prices_total.with({feed}).inc(total_prices);
+        changed_total.with({feed}).inc(changed_prices);
+        candidates_total.with({feed}).inc(candidates.size());
+
+        auto candidate_ids = std::vector<u_int32_t>();
+        candidate_ids.reserve(candidates.size());
+        for (auto& candidate : candidates) {
+            candidate_ids.push_back(candidate.position);
+        }
+        auto book_started = std::chrono::steady_clock::now();
+        auto book_prices = price_loader.load_book_prices(table.ids, candidate_ids);
+        phase_seconds.with({feed, "book"}).observe(std::chrono::steady_clock::now() - book_started);
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            auto& candidate = candidates[i];
+            auto& bond = candidate.bond;
+            auto& blacklisted_ytm = candidate.blacklisted_ytm;
+
+            // The order book can move without a trade, so rejected candidates
+            // are checked again next cycle even if their last price holds
+            auto book_price = book_prices[i];
             if (book_price == 0) {
+                last_prices[candidate.position] = 0;
                 continue;
             }
 
-            price = book_price / 10000.0 * bond.nominal;
-            ytm = (bond.cash_flow / (price + bond.accured_interest) - 1) * 365.0 / bond.dtm * 100;
+            auto price = book_price / 10000.0 * bond.nominal;
+            auto ytm = calc_ytm(book_price, bond.nominal, bond.cash_flow, bond.accured_interest, bond.dtm);
             
             if (ytm < min_ytm) {
+                last_prices[candidate.position] = 0;
                 continue;
             }
 
-            if (blacklisted_params.has_value() && ytm - blacklisted_params.value().max_ytm < 1) {
+            if (blacklisted_ytm.has_value() && ytm - blacklisted_ytm.value() < 1) {
+                last_prices[candidate.position] = 0;
                 continue;
             }
 
@@ -256,7 +535,13 @@ PriceUpdateStats Scanner::update_prices() {
             });
         }
 
+        alerts_total.with({feed}).inc(new_prices.size());
+
+        BOOST_LOG_TRIVIAL(debug) << "Total prices: " << std::to_string(total_prices)
+            << ", changed: " << std::to_string(changed_prices);
+
         if (new_prices.size() != 0) {
+            trace::Span span {"sort"};
             std::sort(new_prices.begin(), new_prices.end(), [](BondYield& a, BondYield& b) {return a.ytm > b.ytm; });
 
             for (auto& price : new_prices) {
@@ -269,9 +554,10 @@ PriceUpdateStats Scanner::update_prices() {
         }
     } catch (const std::exception &ex) {
         BOOST_LOG_TRIVIAL(error) << "Error updating price: " << ex.what();
+        reevaluate_all = true;
     }
 
-    return PriceUpdateStats { prices.size(), new_prices };
+    return PriceUpdateStats { total_prices, new_prices };
 }
 
 void Scanner::temp_blacklist_bonds(const PriceUpdateStats& stats) {
@@ -0,0 +1,164 @@
+#include "scheduler.h"
+
+#include <stdexcept>
+#include <boost/asio/post.hpp>
+#include <boost/log/trivial.hpp>
+
+Scanner::Scheduler::Scheduler(boost::asio::thread_pool& a_thread_pool) :
+    io {},
+    work {boost::asio::make_work_guard(io)},
+    thread_pool {a_thread_pool},
+    tasks {},
+    stats_m {} {}
+
+Scanner::Scheduler::TaskId Scanner::Scheduler::add(
+    const std::string& name,
+    std::chrono::milliseconds interval,
+    Policy policy,
+    std::function<void ()> func) {
+
+    tasks.push_back(std::unique_ptr<Task>(new Task {
+        .name = name,
+        .interval = std::max(interval, std::chrono::milliseconds(1)),
+        .policy = policy,
+        .func = std::move(func),
+        .timer = boost::asio::steady_timer {io},
+        .deadline = clock::now(),
+        .running = false,
+        .pending = false,
+        .pending_since = {},
+        .stats = {},
+        .jitter_seconds = metrics::Registry::shared()
+            .histogram("sscan_scheduler_jitter_seconds", "Delay between a task's scheduled and actual start", {"task"})
+            .with({name}),
+        .skipped_total = metrics::Registry::shared()
+            .counter("sscan_scheduler_skipped_total", "Scheduled runs dropped because the task was still running", {"task"})
+            .with({name})
+    }));
+
+    auto& task = *tasks.back();
+    boost::asio::post(io, [this, &task]() { arm(task); });
+
+    return tasks.size() - 1;
+}
+
+void Scanner::Scheduler::wake(TaskId id) {
+    boost::asio::post(io, [this, id]() {
+        auto& task = *tasks.at(id);
+        if (task.running) {
+            if (!task.pending) {
+                task.pending = true;
+                task.pending_since = clock::now();
+            }
+            return;
+        }
+
+        task.deadline = clock::now();
+        arm(task);
+    });
+}
+
+TaskStats Scanner::Scheduler::get_stats(TaskId id) {
+    std::lock_guard<std::mutex> lock(stats_m);
+    return tasks.at(id)->stats;
+}
+
+void Scanner::Scheduler::run() {
+    io.run();
+}
+
+void Scanner::Scheduler::stop() {
+    work.reset();
+    io.stop();
+}
+
+Scanner::Scheduler::Policy Scanner::Scheduler::parse_policy(const std::string& policy) {
+    if (policy == "skip") {
+        return Policy::SKIP;
+    }
+
+    if (policy == "catch-up") {
+        return Policy::CATCH_UP;
+    }
+
+    throw std::invalid_argument {"Unknown schedule policy: " + policy};
+}
+
+void Scanner::Scheduler::arm(Task& task) {
+    // Re-arming cancels the previous wait, whose handler then sees operation_aborted
+    task.timer.expires_at(task.deadline);
+    task.timer.async_wait([this, &task](boost::system::error_code ec) {
+        if (ec) {
+            return;
+        }
+
+        on_timer(task);
+    });
+}
+
+void Scanner::Scheduler::on_timer(Task& task) {
+    auto scheduled = task.deadline;
+    auto now = clock::now();
+
+    u_int64_t missed = 0;
+    task.deadline += task.interval;
+    if (task.deadline <= now) {
+        missed = (now - task.deadline) / task.interval + 1;
+        task.deadline += missed * task.interval;
+    }
+    arm(task);
+
+    if (task.running) {
+        if (task.policy == Policy::CATCH_UP && !task.pending) {
+            task.pending = true;
+            task.pending_since = scheduled;
+        } else {
+            missed++;
+        }
+    }
+
+    if (missed > 0) {
+        std::lock_guard<std::mutex> lock(stats_m);
+        task.stats.skipped += missed;
+        task.skipped_total.inc(missed);
+    }
+
+    if (!task.running) {
+        execute(task, scheduled);
+    }
+}
+
+void Scanner::Scheduler::execute(Task& task, clock::time_point scheduled) {
+    task.running = true;
+
+    boost::asio::post(thread_pool, [this, &task, scheduled]() {
+        auto jitter = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - scheduled);
+        task.jitter_seconds.observe(jitter);
+        if (jitter > task.interval / 2) {
+            BOOST_LOG_TRIVIAL(debug) << "Task " << task.name << " started late by "
+                << std::to_string(jitter.count() / 1000) << "ms";
+        }
+
+        try {
+            task.func();
+        } catch (const std::exception& ex) {
+            BOOST_LOG_TRIVIAL(error) << "Error in task " << task.name << ": " << ex.what();
+        }
+
+        boost::asio::post(io, [this, &task]() { finish(task); });
+    });
+}
+
+void Scanner::Scheduler::finish(Task& task) {
+    task.running = false;
+
+    {
+        std::lock_guard<std::mutex> lock(stats_m);
+        task.stats.runs++;
+    }
+
+    if (task.pending) {
+        task.pending = false;
+        execute(task, task.pending_since);
+    }
+}
@@ -0,0 +1,68 @@
+#include <sscan/scanner.h>
+#include <sscan/metrics.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+struct TaskStats {
+    u_int64_t runs;
+    u_int64_t skipped;
+};
+
+// Runs periodic tasks on the thread pool from timers on its own io_context.
+// Deadlines follow a fixed grid, so a late start does not shift later cycles.
+// A task never overlaps itself: ticks that land while it is still running are
+// dropped (SKIP) or collapsed into one run right after it finishes (CATCH_UP).
+// How late each run starts is exported as sscan_scheduler_jitter_seconds{task}.
+class Scanner::Scheduler {
+    public:
+        enum class Policy { SKIP, CATCH_UP };
+        using TaskId = size_t;
+        using clock = std::chrono::steady_clock;
+
+        Scheduler(boost::asio::thread_pool& thread_pool);
+
+        Scheduler(const Scheduler& other) = delete;
+        Scheduler& operator=(const Scheduler& other) = delete;
+
+        TaskId add(const std::string& name, std::chrono::milliseconds interval, Policy policy, std::function<void ()> func);
+        // Runs the task as soon as possible, or right after its current run.
+        void wake(TaskId id);
+        TaskStats get_stats(TaskId id);
+
+        void run();
+        void stop();
+
+        static Policy parse_policy(const std::string& policy);
+    private:
+        struct Task {
+            const std::string name;
+            const clock::duration interval;
+            const Policy policy;
+            const std::function<void ()> func;
+            boost::asio::steady_timer timer;
+            clock::time_point deadline;
+            bool running;
+            bool pending;
+            clock::time_point pending_since;
+            TaskStats stats;
+            metrics::Histogram& jitter_seconds;
+            metrics::Counter& skipped_total;
+        };
+
+        boost::asio::io_context io;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work;
+        boost::asio::thread_pool& thread_pool;
+        std::vector<std::unique_ptr<Task>> tasks;
+        std::mutex stats_m;
+
+        void arm(Task& task);
+        void on_timer(Task& task);
+        void execute(Task& task, clock::time_point scheduled);
+        void finish(Task& task);
+};
@@ -0,0 +1,270 @@
+#include "snapshot.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <boost/log/trivial.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr char SNAPSHOT_MAGIC[8] = {'S', 'S', 'C', 'A', 'N', 'B', 'N', 'D'};
+constexpr uint32_t SNAPSHOT_VERSION = 3;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t rejected_count;
+    uint32_t reserved;
+    int64_t created_ns;
+    uint64_t strings_size;
+    uint64_t checksum;
+};
+
+struct SnapshotRecord {
+    uint8_t uid[16];
+    int64_t accured_interest;
+    int64_t nominal;
+    int64_t cash_flow;
+    int32_t dtm;
+    uint32_t isin_size;
+    uint64_t isin_offset;
+    uint64_t name_offset;
+    uint32_t name_size;
+    uint32_t reserved;
+    int64_t loaded_ns;
+    int64_t fetched_ns;
+    int64_t next_coupon_date_ns;
+    int64_t next_coupon;
+};
+
+struct RejectedRecord {
+    uint64_t isin_offset;
+    uint32_t isin_size;
+    uint32_t reserved;
+    int64_t rejected_ns;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader> && sizeof(SnapshotHeader) == 48);
+static_assert(std::is_trivially_copyable_v<SnapshotRecord> && sizeof(SnapshotRecord) == 104);
+static_assert(std::is_trivially_copyable_v<RejectedRecord> && sizeof(RejectedRecord) == 24);
+
+int64_t to_ns(const std::chrono::system_clock::time_point& t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point from_ns(const int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+uint64_t fnv1a(const char* data, size_t size, uint64_t hash = 14695981039346656037ULL) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+class MappedFile {
+    public:
+        MappedFile(const std::string& path) : data {nullptr}, size {0} {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return;
+            }
+
+            struct stat st;
+            if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+                void* mapped = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    data = static_cast<const char*>(mapped);
+                    size = st.st_size;
+                }
+            }
+            ::close(fd);
+        }
+
+        ~MappedFile() {
+            if (data != nullptr) {
+                ::munmap(const_cast<char*>(data), size);
+            }
+        }
+
+        MappedFile(const MappedFile& other) = delete;
+        MappedFile& operator=(const MappedFile& other) = delete;
+
+        const char* data;
+        size_t size;
+};
+
+// Flushes a written file, or a directory after a rename in it, to the disk
+void sync_path(const std::string& path, const int flags) {
+    int fd = ::open(path.c_str(), O_RDONLY | flags);
+    if (fd < 0) {
+        throw std::runtime_error {"Unable to open " + path + ": " + std::strerror(errno)};
+    }
+
+    auto result = ::fsync(fd);
+    auto error = errno;
+    ::close(fd);
+    if (result != 0) {
+        throw std::runtime_error {"Unable to sync " + path + ": " + std::strerror(error)};
+    }
+}
+
+void write_snapshot(const std::string& path, const BondsSnapshot& snapshot) {
+    auto records = std::vector<SnapshotRecord>();
+    records.reserve(snapshot.bonds.size());
+    std::string strings;
+
+    for (auto& bond : snapshot.bonds) {
+        SnapshotRecord record {};
+        std::memcpy(record.uid, bond.uid.data, sizeof(record.uid));
+        record.accured_interest = bond.accured_interest;
+        record.nominal = bond.nominal;
+        record.cash_flow = bond.cash_flow;
+        record.dtm = bond.dtm;
+        record.isin_offset = strings.size();
+        record.isin_size = bond.isin.size();
+        strings += bond.isin;
+        record.name_offset = strings.size();
+        record.name_size = bond.name.size();
+        strings += bond.name;
+        record.loaded_ns = to_ns(bond.loaded);
+        record.fetched_ns = to_ns(bond.fetched);
+        record.next_coupon_date_ns = to_ns(bond.next_coupon_date);
+        record.next_coupon = bond.next_coupon;
+        records.push_back(record);
+    }
+
+    auto rejected_records = std::vector<RejectedRecord>();
+    rejected_records.reserve(snapshot.rejected.size());
+    for (auto& rejected : snapshot.rejected) {
+        RejectedRecord record {};
+        record.isin_offset = strings.size();
+        record.isin_size = rejected.isin.size();
+        strings += rejected.isin;
+        record.rejected_ns = to_ns(rejected.rejected);
+        rejected_records.push_back(record);
+    }
+
+    SnapshotHeader header {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.count = records.size();
+    header.rejected_count = rejected_records.size();
+    header.created_ns = to_ns(snapshot.created);
+    header.strings_size = strings.size();
+
+    auto records_data = reinterpret_cast<const char*>(records.data());
+    auto records_size = records.size() * sizeof(SnapshotRecord);
+    auto rejected_data = reinterpret_cast<const char*>(rejected_records.data());
+    auto rejected_size = rejected_records.size() * sizeof(RejectedRecord);
+    header.checksum = fnv1a(strings.data(), strings.size(), 
+        fnv1a(rejected_data, rejected_size, fnv1a(records_data, records_size)));
+
+    auto tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(records_data, records_size);
+        out.write(rejected_data, rejected_size);
+        out.write(strings.data(), strings.size());
+        out.flush();
+        if (!out) {
+            throw std::runtime_error {"Unable to write snapshot " + tmp_path};
+        }
+    }
+
+    // Without the syncs a crash can leave the new name pointing at unwritten data
+    sync_path(tmp_path, 0);
+    std::filesystem::rename(tmp_path, path);
+    auto dir = std::filesystem::path(path).parent_path();
+    sync_path(dir.empty() ? "." : dir.string(), O_DIRECTORY);
+}
+
+std::optional<BondsSnapshot> read_snapshot(const std::string& path) {
+    MappedFile file(path);
+    if (file.data == nullptr || file.size < sizeof(SnapshotHeader)) {
+        return {};
+    }
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.data, sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 || header.version != SNAPSHOT_VERSION) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring snapshot " << path << " with unsupported format";
+        return {};
+    }
+
+    auto records_size = static_cast<uint64_t>(header.count) * sizeof(SnapshotRecord);
+    auto rejected_size = static_cast<uint64_t>(header.rejected_count) * sizeof(RejectedRecord);
+    if (file.size != sizeof(SnapshotHeader) + records_size + rejected_size + header.strings_size) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring truncated snapshot " << path;
+        return {};
+    }
+
+    const char* records = file.data + sizeof(SnapshotHeader);
+    const char* rejected_records = records + records_size;
+    const char* strings = rejected_records + rejected_size;
+    if (fnv1a(strings, header.strings_size, fnv1a(rejected_records, rejected_size, fnv1a(records, records_size))) != header.checksum) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring corrupted snapshot " << path;
+        return {};
+    }
+
+    auto bonds = std::vector<BondInfo>();
+    bonds.reserve(header.count);
+    for (uint32_t i = 0; i < header.count; i++) {
+        SnapshotRecord record;
+        std::memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(record));
+        if (record.isin_offset + record.isin_size > header.strings_size || 
+            record.name_offset + record.name_size > header.strings_size) {
+            BOOST_LOG_TRIVIAL(warning) << "Ignoring corrupted snapshot " << path;
+            return {};
+        }
+
+        boost::uuids::uuid uid;
+        std::memcpy(uid.data, record.uid, sizeof(record.uid));
+        bonds.push_back(BondInfo {
+            .isin = std::string(strings + record.isin_offset, record.isin_size),
+            .uid = uid,
+            .name = std::string(strings + record.name_offset, record.name_size),
+            .accured_interest = record.accured_interest,
+            .nominal = record.nominal,
+            .cash_flow = record.cash_flow,
+            .dtm = record.dtm,
+            .loaded = from_ns(record.loaded_ns),
+            .fetched = from_ns(record.fetched_ns),
+            .next_coupon_date = from_ns(record.next_coupon_date_ns),
+            .next_coupon = record.next_coupon
+        });
+    }
+
+    auto rejected = std::vector<RejectedIsin>();
+    rejected.reserve(header.rejected_count);
+    for (uint32_t i = 0; i < header.rejected_count; i++) {
+        RejectedRecord record;
+        std::memcpy(&record, rejected_records + i * sizeof(RejectedRecord), sizeof(record));
+        if (record.isin_offset + record.isin_size > header.strings_size) {
+            BOOST_LOG_TRIVIAL(warning) << "Ignoring corrupted snapshot " << path;
+            return {};
+        }
+
+        rejected.push_back(RejectedIsin {
+            .isin = std::string(strings + record.isin_offset, record.isin_size),
+            .rejected = from_ns(record.rejected_ns)
+        });
+    }
+
+    return BondsSnapshot {
+        .created = from_ns(header.created_ns),
+        .bonds = std::move(bonds),
+        .rejected = std::move(rejected)
+    };
+}
@@ -0,0 +1,30 @@
+#ifndef SECURITIES_SCANNER_SNAPSHOT_H
+#define SECURITIES_SCANNER_SNAPSHOT_H
+
+#include <sscan/bond_info.h>
+#include <chrono>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct RejectedIsin {
+    std::string isin;
+    std::chrono::system_clock::time_point rejected;
+};
+
+struct BondsSnapshot {
+    std::chrono::system_clock::time_point created;
+    std::vector<BondInfo> bonds;
+    std::vector<RejectedIsin> rejected;
+};
+
+// Writes the bond table to a versioned binary file. The file is written next to
+// the target, synced and renamed over it, so neither readers nor a crash leave
+// a partial snapshot behind.
+void write_snapshot(const std::string& path, const BondsSnapshot& snapshot);
+
+// Maps the snapshot file into memory and decodes it. Returns an empty optional
+// when the file is missing, has a different version or fails validation.
+std::optional<BondsSnapshot> read_snapshot(const std::string& path);
+
+#endif // SECURITIES_SCANNER_SNAPSHOT_H
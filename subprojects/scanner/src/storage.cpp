@@ -1,27 +1,243 @@
 #include "storage.h"
+#include "snapshot.h"
 
-Scanner::Storage::Storage(BondsLoader& bonds_loader, const std::chrono::time_zone* a_tz) : 
-    loader {bonds_loader},
-     tz {a_tz},
-     min_ytm {20.0},
-     min_dtm {60},
-     temporally_blacklist_m {},
-     temporally_blacklisted_bonds {} {}
+#include <sscan/metrics.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+#include <boost/log/trivial.hpp>
 
-u_int64_t Scanner::Storage::load() {
-    auto bonds_vec = loader.load();
+using time_point = std::chrono::system_clock::time_point;
+
+UidsMap<BondInfo> to_uids_map(const std::vector<BondInfo>& bonds_vec) {
     auto bonds_map = UidsMap<BondInfo>();
     bonds_map.reserve(bonds_vec.size());
     for (auto& bond : bonds_vec) {
         bonds_map.insert({bond.uid, bond});
     }
-    
-    bonds = std::make_shared<UidsMap<BondInfo>>(std::move(bonds_map));
-    return bonds->size();
+    return bonds_map;
+}
+
+BondInfo age_bond(const BondInfo& bond, const time_point& now) {
+    auto elapsed = std::chrono::floor<std::chrono::days>(now - bond.loaded);
+    if (elapsed.count() <= 0) {
+        return bond;
+    }
+
+    auto accured_interest = bond.accured_interest;
+    if (bond.next_coupon_date != time_point::max() && bond.next_coupon_date > bond.loaded) {
+        auto coupon_period = std::chrono::duration<double, std::chrono::days::period>(bond.next_coupon_date - bond.loaded);
+        auto accrual = std::min(elapsed.count() / coupon_period.count(), 1.0);
+        accured_interest += std::lround((bond.next_coupon - bond.accured_interest) * accrual);
+    }
+
+    return BondInfo {
+        .isin = bond.isin,
+        .uid = bond.uid,
+        .name = bond.name,
+        .accured_interest = accured_interest,
+        .nominal = bond.nominal,
+        .cash_flow = bond.cash_flow,
+        .dtm = bond.dtm - static_cast<int>(elapsed.count()),
+        .loaded = bond.loaded + elapsed,
+        .fetched = bond.fetched,
+        .next_coupon_date = bond.next_coupon_date,
+        .next_coupon = bond.next_coupon
+    };
+}
+
+bool needs_reload(const BondInfo& bond, const time_point& now, const std::chrono::days full_refresh_interval) {
+    return bond.next_coupon_date <= now || now - bond.fetched >= full_refresh_interval;
+}
+
+Scanner::Storage::Storage(BondsLoader& bonds_loader, const std::chrono::time_zone* a_tz, const StorageConfig& a_config) : 
+    loader {bonds_loader},
+     tz {a_tz},
+     config {a_config},
+     bonds {},
+     table {},
+     ceilings {},
+     ceilings_m {},
+     rejected {},
+     min_ytm {20.0},
+     min_dtm {60},
+     blacklist_m {},
+     blacklist {},
+     next_expiry {time_point::max()} {}
+
+UniverseDelta Scanner::Storage::refresh() {
+    static auto& reload_seconds = metrics::Registry::shared().histogram(
+        "sscan_reload_seconds", "Duration of bond universe refreshes",
+        {}, {1, 5, 15, 30, 60, 120, 300, 600, 1200}).with({});
+    metrics::Timer timer {reload_seconds};
+
+    auto now = std::chrono::system_clock::now();
+    auto full_refresh_interval = std::chrono::days(config.full_refresh_days);
+
+    auto isins = loader.find_all();
+    if (isins.empty()) {
+        throw std::runtime_error {"No bonds found on rank pages"};
+    }
+
+    auto current = get_bonds();
+    if (!current) {
+        current = std::make_shared<UidsMap<BondInfo>>();
+    }
+
+    auto bonds_vec = std::vector<BondInfo>();
+    bonds_vec.reserve(current->size());
+    auto known_isins = std::unordered_set<std::string>();
+    auto reload_isins = std::vector<std::string>();
+
+    for (auto& entry : *current) {
+        auto& bond = entry.second;
+        known_isins.insert(bond.isin);
+        if (!isins.contains(bond.isin)) {
+            continue;
+        }
+
+        if (needs_reload(bond, now, full_refresh_interval)) {
+            reload_isins.push_back(bond.isin);
+            continue;
+        }
+
+        auto aged_bond = age_bond(bond, now);
+        if (aged_bond.dtm > 0) {
+            bonds_vec.push_back(aged_bond);
+        }
+    }
+
+    std::erase_if(rejected, [&](const auto& entry) { 
+        return !isins.contains(entry.first) || now - entry.second >= full_refresh_interval; 
+    });
+
+    for (auto& isin : isins) {
+        if (!known_isins.contains(isin) && !rejected.contains(isin)) {
+            reload_isins.push_back(isin);
+        }
+    }
+
+    BOOST_LOG_TRIVIAL(debug) << "Bonds to reload: " << std::to_string(reload_isins.size()) 
+        << " of " << std::to_string(isins.size());
+
+    auto loaded_bonds = loader.load(reload_isins);
+    auto loaded_isins = std::unordered_set<std::string>();
+    for (auto& bond : loaded_bonds) {
+        loaded_isins.insert(bond.isin);
+        bonds_vec.push_back(bond);
+    }
+
+    for (auto& isin : reload_isins) {
+        if (!loaded_isins.contains(isin)) {
+            rejected[isin] = now;
+        }
+    }
+
+    auto bonds_map = std::make_shared<UidsMap<BondInfo>>(to_uids_map(bonds_vec));
+    auto delta = UniverseDelta { .added = {}, .removed = {}, .updated = {}, .total = bonds_map->size() };
+    for (auto& bond : loaded_bonds) {
+        if (current->contains(bond.uid)) {
+            delta.updated.push_back(bond.uid);
+        } else {
+            delta.added.push_back(bond.uid);
+        }
+    }
+    for (auto& entry : *current) {
+        if (!bonds_map->contains(entry.first)) {
+            delta.removed.push_back(entry.first);
+        }
+    }
+
+    publish(std::move(bonds_map));
+
+    try {
+        auto rejected_vec = std::vector<RejectedIsin>();
+        rejected_vec.reserve(rejected.size());
+        for (auto& entry : rejected) {
+            rejected_vec.push_back(RejectedIsin { .isin = entry.first, .rejected = entry.second });
+        }
+
+        write_snapshot(config.snapshot_path, BondsSnapshot { 
+            .created = now, 
+            .bonds = std::move(bonds_vec), 
+            .rejected = std::move(rejected_vec) 
+        });
+    } catch (const std::exception& ex) {
+        BOOST_LOG_TRIVIAL(error) << "Error writing bonds snapshot: " << ex.what();
+    }
+
+    return delta;
+}
+
+std::optional<time_point> Scanner::Storage::restore() {
+    auto snapshot = read_snapshot(config.snapshot_path);
+    if (!snapshot.has_value()) {
+        return {};
+    }
+
+    auto now = std::chrono::system_clock::now();
+    auto bonds_vec = std::vector<BondInfo>();
+    bonds_vec.reserve(snapshot->bonds.size());
+    for (auto& bond : snapshot->bonds) {
+        auto aged_bond = age_bond(bond, now);
+        if (aged_bond.dtm > 0) {
+            bonds_vec.push_back(aged_bond);
+        }
+    }
+
+    for (auto& entry : snapshot->rejected) {
+        rejected[entry.isin] = entry.rejected;
+    }
+
+    publish(std::make_shared<UidsMap<BondInfo>>(to_uids_map(bonds_vec)));
+    BOOST_LOG_TRIVIAL(info) << "Restored " << bonds_vec.size() << " bonds from snapshot " << config.snapshot_path;
+
+    return snapshot->created;
 }
 
 std::shared_ptr<UidsMap<BondInfo>> Scanner::Storage::get_bonds() {
-    return bonds;
+    return bonds.load();
+}
+
+std::shared_ptr<const BondTable> Scanner::Storage::get_table() {
+    return table.load();
+}
+
+std::shared_ptr<const PriceCeilings> Scanner::Storage::get_ceilings() {
+    return ceilings.load();
+}
+
+// The table, its ceilings and blacklist go first, so whoever sees the new map also sees them
+void Scanner::Storage::publish(std::shared_ptr<UidsMap<BondInfo>> bonds_map) {
+    static auto& universe_bonds = metrics::Registry::shared().gauge(
+        "sscan_universe_bonds", "Bonds in the published universe").with({});
+    universe_bonds.set(bonds_map->size());
+
+    auto new_table = make_bond_table(bonds_map);
+    table.store(new_table);
+    update_ceilings();
+
+    {
+        std::lock_guard<std::mutex> lock(blacklist_m);
+        auto new_blacklist = std::make_shared<Blacklist>(new_table);
+        auto current = blacklist.load();
+        if (current) {
+            new_blacklist->copy_from(*current);
+        }
+        blacklist.store(std::move(new_blacklist));
+    }
+
+    bonds.store(std::move(bonds_map));
+}
+
+void Scanner::Storage::update_ceilings() {
+    std::lock_guard<std::mutex> lock(ceilings_m);
+    auto current_table = table.load();
+    if (current_table) {
+        ceilings.store(make_price_ceilings(std::move(current_table), min_ytm, min_dtm));
+    }
 }
 
 double Scanner::Storage::get_min_ytm() {
@@ -30,6 +246,7 @@ double Scanner::Storage::get_min_ytm() {
 
 void Scanner::Storage::set_min_ytm(double ytm) {
     this->min_ytm = ytm;
+    update_ceilings();
 }
 
 int Scanner::Storage::get_min_dtm() {
@@ -38,38 +255,123 @@ int Scanner::Storage::get_min_dtm() {
 
 void Scanner::Storage::set_min_dtm(int days) {
     this->min_dtm = days;
+    update_ceilings();
 }
 
 void Scanner::Storage::blacklist_temporally(const boost::uuids::uuid& uid, const BlacklistParams& params) {
-    std::unique_lock<std::shared_mutex> wlock(temporally_blacklist_m);
-    temporally_blacklisted_bonds[uid] = BlacklistParams { params };
+    std::lock_guard<std::mutex> lock(blacklist_m);
+    auto current = blacklist.load();
+    if (!current) {
+        return;
+    }
+
+    auto position = current->table->ids.find(uid);
+    if (position == InstrumentIds::NONE) {
+        return;
+    }
+
+    auto until = params.until.get_sys_time();
+    current->set(position, params.max_ytm, until);
+    if (until < next_expiry.load()) {
+        next_expiry = until;
+    }
+}
+
+std::shared_ptr<const Blacklist> Scanner::Storage::get_blacklist() {
+    return blacklist.load();
+}
+
+// Entries share the 08:00 expiry, so this sweeps once when it passes and
+// returns right away on every other call
+bool Scanner::Storage::expire_blacklist() {
+    auto now = std::chrono::system_clock::now();
+    if (now < next_expiry.load()) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(blacklist_m);
+    auto current = blacklist.load();
+    next_expiry = current ? current->expire(now) : time_point::max();
+    BOOST_LOG_TRIVIAL(debug) << "Expired temporary blacklist";
+    return true;
 }
 
 void Scanner::Storage::reset_blacklist() {
-    temporally_blacklisted_bonds = {};
+    std::lock_guard<std::mutex> lock(blacklist_m);
+    auto current = blacklist.load();
+    if (current) {
+        current->clear();
+    }
+    next_expiry = time_point::max();
 }
 
-std::optional<Scanner::BlacklistParams> Scanner::Storage::get_blacklisted(const boost::uuids::uuid& uid) {
-    auto now = std::chrono::zoned_time(tz, std::chrono::system_clock::now());
-    {
-        std::shared_lock<std::shared_mutex> rlock(temporally_blacklist_m);
-        auto params_it = temporally_blacklisted_bonds.find(uid);
-        if (params_it == temporally_blacklisted_bonds.end()) {
+Blacklist::Blacklist(std::shared_ptr<const BondTable> a_table) :
+    table {std::move(a_table)},
+    slots(table->size()) {
+
+    for (auto& slot : slots) {
+        slot.max_ytm.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_relaxed);
+        slot.until.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::optional<double> Blacklist::get_max_ytm(const BondTable& other_table, u_int32_t position) const {
+    if (&other_table != table.get()) {
+        position = table->ids.find(other_table.ids.uid(position));
+        if (position == InstrumentIds::NONE) {
             return {};
         }
     }
 
-    std::unique_lock<std::shared_mutex> wlock(temporally_blacklist_m);
-    auto params_it = temporally_blacklisted_bonds.find(uid);
-    if (params_it == temporally_blacklisted_bonds.end()) {
+    auto max_ytm = slots[position].max_ytm.load(std::memory_order_acquire);
+    if (std::isnan(max_ytm)) {
         return {};
     }
+    return max_ytm;
+}
+
+void Blacklist::set(u_int32_t position, double max_ytm, time_point until) {
+    slots[position].until.store(until.time_since_epoch().count(), std::memory_order_relaxed);
+    slots[position].max_ytm.store(max_ytm, std::memory_order_release);
+}
+
+time_point Blacklist::expire(time_point now) {
+    auto next = time_point::max();
+    auto now_rep = now.time_since_epoch().count();
+    for (auto& slot : slots) {
+        if (std::isnan(slot.max_ytm.load(std::memory_order_relaxed))) {
+            continue;
+        }
+
+        auto until = slot.until.load(std::memory_order_relaxed);
+        if (until <= now_rep) {
+            slot.max_ytm.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_release);
+        } else {
+            next = std::min(next, time_point(time_point::duration(until)));
+        }
+    }
+    return next;
+}
 
-    zoned_time until = params_it->second.until;
-    if (until.get_local_time() > now.get_local_time()) {
-        return std::optional { params_it->second };
+void Blacklist::clear() {
+    for (auto& slot : slots) {
+        slot.max_ytm.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_release);
     }
+}
+
+void Blacklist::copy_from(const Blacklist& other) {
+    for (size_t other_position = 0; other_position < other.slots.size(); other_position++) {
+        auto& other_slot = other.slots[other_position];
+        auto max_ytm = other_slot.max_ytm.load(std::memory_order_acquire);
+        if (std::isnan(max_ytm)) {
+            continue;
+        }
 
-    temporally_blacklisted_bonds.erase(uid);
-    return {};
-}
\ No newline at end of file
+        auto position = table->ids.find(other.table->ids.uid(other_position));
+        if (position != InstrumentIds::NONE) {
+            auto& slot = slots[position];
+            slot.until.store(other_slot.until.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            slot.max_ytm.store(max_ytm, std::memory_order_relaxed);
+        }
+    }
+}
@@ -1,17 +1,64 @@
+#include "bond_table.h"
+
 #include <sscan/scanner.h>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Moves the bond forward by the whole days passed since it was loaded. Coupons are
+// fixed, so accrued interest grows linearly until it reaches the next coupon.
+BondInfo age_bond(const BondInfo& bond, const std::chrono::system_clock::time_point& now);
 
-template<typename V>
-using UidsMap = std::unordered_map<boost::uuids::uuid, V, boost::hash<boost::uuids::uuid>>;
-using UidSet = std::vector<boost::uuids::uuid>;
+// A bond is fetched again once its coupon is paid or the broker has not
+// confirmed it for full_refresh_interval, however often it was aged since
+bool needs_reload(const BondInfo& bond, const std::chrono::system_clock::time_point& now, const std::chrono::days full_refresh_interval);
+
+struct UniverseDelta {
+    std::vector<boost::uuids::uuid> added;
+    std::vector<boost::uuids::uuid> removed;
+    std::vector<boost::uuids::uuid> updated;
+    u_int64_t total;
+};
 
 struct Scanner::BlacklistParams {
     zoned_time until;
     double max_ytm;
 };
 
+// Temporary blacklist laid out by the positions of one bond table. Readers only
+// load atomics; writers are serialised by Storage.
+class Blacklist {
+    public:
+        Blacklist(std::shared_ptr<const BondTable> table);
+
+        Blacklist(const Blacklist& other) = delete;
+        Blacklist& operator=(const Blacklist& other) = delete;
+
+        // Positions of another table are mapped through the bond uid
+        std::optional<double> get_max_ytm(const BondTable& table, u_int32_t position) const;
+
+        void set(u_int32_t position, double max_ytm, std::chrono::system_clock::time_point until);
+        // Clears entries that expire at or before the time and returns the earliest remaining expiry
+        std::chrono::system_clock::time_point expire(std::chrono::system_clock::time_point now);
+        void clear();
+        void copy_from(const Blacklist& other);
+
+        const std::shared_ptr<const BondTable> table;
+    private:
+        struct Slot {
+            std::atomic<double> max_ytm;
+            std::atomic<std::chrono::system_clock::rep> until;
+        };
+
+        std::vector<Slot> slots;
+};
+
 class Scanner::Storage {
     public:
-        Storage(BondsLoader& loader, const std::chrono::time_zone* a_tz);
+        Storage(BondsLoader& loader, const std::chrono::time_zone* a_tz, const StorageConfig& config);
 
         Storage(const Storage& other) = delete;
         Storage& operator=(const Storage& other) = delete;
@@ -19,8 +66,11 @@ class Scanner::Storage {
         Storage(Storage&& other) = default;
         Storage& operator=(Storage&& other) = default;
 
-        u_int64_t load();
+        UniverseDelta refresh();
+        std::optional<std::chrono::system_clock::time_point> restore();
         std::shared_ptr<UidsMap<BondInfo>> get_bonds();
+        std::shared_ptr<const BondTable> get_table();
+        std::shared_ptr<const PriceCeilings> get_ceilings();
 
         double get_min_ytm();
         void set_min_ytm(double ytm);
@@ -29,15 +79,26 @@ class Scanner::Storage {
         void set_min_dtm(int days);
 
         void blacklist_temporally(const boost::uuids::uuid& uid, const BlacklistParams& params);
-        std::optional<BlacklistParams> get_blacklisted(const boost::uuids::uuid& uid);
+        std::shared_ptr<const Blacklist> get_blacklist();
+        // Returns true when a sweep expired entries
+        bool expire_blacklist();
         void reset_blacklist();
     private:
         BondsLoader& loader;
         const std::chrono::time_zone* tz;
-        std::shared_ptr<UidsMap<BondInfo>> bonds;
+        const StorageConfig& config;
+        std::atomic<std::shared_ptr<UidsMap<BondInfo>>> bonds;
+        std::atomic<std::shared_ptr<const BondTable>> table;
+        std::atomic<std::shared_ptr<const PriceCeilings>> ceilings;
+        std::mutex ceilings_m;
+        std::unordered_map<std::string, std::chrono::system_clock::time_point> rejected;
 
         double min_ytm;
         int min_dtm;
-        std::shared_mutex temporally_blacklist_m;
-        UidsMap<BlacklistParams> temporally_blacklisted_bonds;
+        std::mutex blacklist_m;
+        std::atomic<std::shared_ptr<Blacklist>> blacklist;
+        std::atomic<std::chrono::system_clock::time_point> next_expiry;
+
+        void publish(std::shared_ptr<UidsMap<BondInfo>> bonds_map);
+        void update_ceilings();
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "storage.h"
+#include "snapshot.h"
+
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+
+// Ages a bond through daily refreshes and restores the way Storage does and
+// checks that it is fetched again after full-refresh-days, not only at its coupon.
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        failures++;
+        std::cerr << "FAILED: " << what << std::endl;
+    }
+}
+
+BondInfo make_bond(const std::chrono::system_clock::time_point& fetched, const int coupon_days) {
+    return BondInfo {
+        .isin = "RU000A0TEST0",
+        .uid = {},
+        .name = "Test bond",
+        .accured_interest = 1000,
+        .nominal = 100000,
+        .cash_flow = 120000,
+        .dtm = 365,
+        .loaded = fetched,
+        .fetched = fetched,
+        .next_coupon_date = fetched + std::chrono::days(coupon_days),
+        .next_coupon = 5000
+    };
+}
+
+// Days until the bond is queued for reloading, aging it once a day in between
+int days_until_reload(const BondInfo& fetched_bond, const int full_refresh_days, const std::string& snapshot_path) {
+    auto start = fetched_bond.fetched;
+    // BondInfo is immutable, every refresh replaces it
+    auto bond = std::optional<BondInfo> {fetched_bond};
+    for (int day = 1; day <= 1000; day++) {
+        auto now = start + std::chrono::days(day) + std::chrono::minutes(day);
+        if (needs_reload(*bond, now, std::chrono::days(full_refresh_days))) {
+            return day;
+        }
+
+        auto aged = std::optional<BondInfo> {age_bond(*bond, now)};
+        if (!snapshot_path.empty()) {
+            write_snapshot(snapshot_path, BondsSnapshot { .created = now, .bonds = {*aged}, .rejected = {} });
+            auto restored = read_snapshot(snapshot_path);
+            check(restored.has_value() && restored->bonds.size() == 1, "snapshot restored");
+            if (!restored.has_value() || restored->bonds.empty()) {
+                return -1;
+            }
+            aged.emplace(age_bond(restored->bonds.front(), now));
+        }
+
+        check(aged->fetched == start, "aging keeps fetched on day " + std::to_string(day));
+        check(aged->dtm == bond->dtm - 1, "aging takes a day off dtm on day " + std::to_string(day));
+        bond.emplace(*aged);
+    }
+
+    return -1;
+}
+
+int main() {
+    auto fetched = std::chrono::system_clock::time_point {} + std::chrono::days(20000);
+    auto snapshot_path = (std::filesystem::temp_directory_path() / "sscan_storage_test.snapshot").string();
+
+    for (auto full_refresh_days : {1, 3, 7, 30}) {
+        auto days = days_until_reload(make_bond(fetched, 180), full_refresh_days, "");
+        check(days == full_refresh_days, "reload after " + std::to_string(full_refresh_days)
+            + " daily refreshes, got " + std::to_string(days));
+
+        days = days_until_reload(make_bond(fetched, 180), full_refresh_days, snapshot_path);
+        check(days == full_refresh_days, "reload after " + std::to_string(full_refresh_days)
+            + " daily restores, got " + std::to_string(days));
+    }
+
+    // A coupon before the full refresh still comes first
+    auto days = days_until_reload(make_bond(fetched, 3), 7, "");
+    check(days == 3, "reload at the coupon, got " + std::to_string(days));
+
+    std::filesystem::remove(snapshot_path);
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
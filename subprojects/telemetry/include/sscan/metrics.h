@@ -0,0 +1,183 @@
+#ifndef SECURITIES_SCANNER_METRICS_H
+#define SECURITIES_SCANNER_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Prometheus style metrics. Updating a metric is a relaxed atomic operation, so
+// instrumented code resolves its metric once and keeps the reference; families
+// only take a lock when a new label combination first appears.
+namespace metrics {
+
+    using Labels = std::vector<std::string>;
+
+    class Counter {
+        public:
+            Counter();
+
+            Counter(const Counter& other) = delete;
+            Counter& operator=(const Counter& other) = delete;
+
+            void inc(u_int64_t value = 1);
+            u_int64_t value() const;
+
+            void render(std::string& out, const std::string& name, const std::string& labels) const;
+        private:
+            // Threads add to their own cache line and readers sum the shards
+            struct alignas(64) Shard {
+                std::atomic<u_int64_t> value;
+            };
+
+            std::array<Shard, 16> shards;
+    };
+
+    class Gauge {
+        public:
+            Gauge();
+
+            Gauge(const Gauge& other) = delete;
+            Gauge& operator=(const Gauge& other) = delete;
+
+            void set(double value);
+            void add(double value);
+            double value() const;
+
+            void render(std::string& out, const std::string& name, const std::string& labels) const;
+        private:
+            std::atomic<double> current;
+    };
+
+    class Histogram {
+        public:
+            explicit Histogram(std::vector<double> bounds);
+
+            Histogram(const Histogram& other) = delete;
+            Histogram& operator=(const Histogram& other) = delete;
+
+            void observe(double value);
+
+            template<typename Rep, typename Period>
+            void observe(std::chrono::duration<Rep, Period> value) {
+                observe(std::chrono::duration<double>(value).count());
+            }
+
+            u_int64_t count() const;
+            double sum() const;
+
+            void render(std::string& out, const std::string& name, const std::string& labels) const;
+        private:
+            const std::vector<double> bounds;
+            // One slot per bound plus +Inf
+            std::unique_ptr<std::atomic<u_int64_t>[]> buckets;
+            std::atomic<double> total;
+    };
+
+    // Bounds in seconds from 1ms to 30s
+    const std::vector<double>& latency_buckets();
+
+    class FamilyBase {
+        public:
+            FamilyBase(const std::string& name, const std::string& help, const std::string& type, Labels label_names);
+            virtual ~FamilyBase() = default;
+
+            void render(std::string& out) const;
+        protected:
+            const std::string name;
+            const std::string help;
+            const std::string type;
+            const Labels label_names;
+            mutable std::shared_mutex m;
+
+            std::string format_labels(const Labels& values) const;
+            virtual void render_metrics(std::string& out) const = 0;
+    };
+
+    // Metrics of one name, one per combination of label values
+    template<typename M>
+    class Family : public FamilyBase {
+        public:
+            template<typename... Args>
+            Family(const std::string& name, const std::string& help, const std::string& type, Labels label_names, Args... args) :
+                FamilyBase(name, help, type, std::move(label_names)),
+                make {[args...]() { return std::make_unique<M>(args...); }},
+                children {} {}
+
+            M& with(const Labels& values) {
+                {
+                    std::shared_lock<std::shared_mutex> rlock(m);
+                    auto metric_it = children.find(values);
+                    if (metric_it != children.end()) {
+                        return *metric_it->second;
+                    }
+                }
+
+                std::unique_lock<std::shared_mutex> wlock(m);
+                auto& metric = children[values];
+                if (!metric) {
+                    metric = make();
+                }
+                return *metric;
+            }
+        private:
+            const std::function<std::unique_ptr<M> ()> make;
+            std::map<Labels, std::unique_ptr<M>> children;
+
+            void render_metrics(std::string& out) const override {
+                for (auto& entry : children) {
+                    entry.second->render(out, name, format_labels(entry.first));
+                }
+            }
+    };
+
+    class Registry {
+        public:
+            Registry();
+
+            Registry(const Registry& other) = delete;
+            Registry& operator=(const Registry& other) = delete;
+
+            // Registering a name again returns the existing family
+            Family<Counter>& counter(const std::string& name, const std::string& help, Labels label_names = {});
+            Family<Gauge>& gauge(const std::string& name, const std::string& help, Labels label_names = {});
+            Family<Histogram>& histogram(
+                const std::string& name,
+                const std::string& help,
+                Labels label_names = {},
+                const std::vector<double>& bounds = latency_buckets());
+
+            // Text exposition format
+            std::string render() const;
+
+            static Registry& shared();
+        private:
+            mutable std::mutex m;
+            std::map<std::string, std::unique_ptr<FamilyBase>> families;
+
+            template<typename M, typename... Args>
+            Family<M>& add(const std::string& name, const std::string& help, const std::string& type, Labels label_names, Args... args);
+    };
+
+    // Observes the lifetime of the scope into a histogram
+    class Timer {
+        public:
+            explicit Timer(Histogram& histogram);
+            ~Timer();
+
+            Timer(const Timer& other) = delete;
+            Timer& operator=(const Timer& other) = delete;
+        private:
+            Histogram& histogram;
+            const std::chrono::steady_clock::time_point started;
+    };
+
+}
+
+#endif // SECURITIES_SCANNER_METRICS_H
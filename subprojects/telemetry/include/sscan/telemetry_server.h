@@ -0,0 +1,47 @@
+#ifndef SECURITIES_SCANNER_TELEMETRY_SERVER_H
+#define SECURITIES_SCANNER_TELEMETRY_SERVER_H
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Plain HTTP endpoint for local scraping and diagnostics. A GET on a routed path
+// returns the handler's output; handlers run on the server's own thread.
+class TelemetryServer {
+    public:
+        using Handler = std::function<std::string (std::string_view query)>;
+
+        TelemetryServer(const std::string& host, const int port);
+        ~TelemetryServer();
+
+        TelemetryServer(const TelemetryServer& other) = delete;
+        TelemetryServer& operator=(const TelemetryServer& other) = delete;
+
+        // Routes are fixed once the server is started
+        void route(const std::string& path, const std::string& content_type, Handler handler);
+
+        void start();
+        void stop();
+    private:
+        struct Route {
+            std::string content_type;
+            Handler handler;
+        };
+        class Session;
+
+        const std::string host;
+        const int port;
+        boost::asio::io_context io;
+        std::optional<boost::asio::ip::tcp::acceptor> acceptor;
+        std::map<std::string, Route, std::less<>> routes;
+        std::thread thread;
+
+        void accept();
+};
+
+#endif // SECURITIES_SCANNER_TELEMETRY_SERVER_H
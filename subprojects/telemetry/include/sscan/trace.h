@@ -0,0 +1,48 @@
+#ifndef SECURITIES_SCANNER_TRACE_H
+#define SECURITIES_SCANNER_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+// Scoped spans recorded into per-thread ring buffers and exported as Chrome
+// trace_event JSON (chrome://tracing, Perfetto). While tracing is off a span is
+// a single relaxed load; while on it is two clock reads and a few relaxed stores.
+namespace trace {
+
+    using clock = std::chrono::steady_clock;
+
+    // Span names and categories must outlive the process, string literals in practice
+    void record(const char* name, const char* category, clock::time_point start, clock::time_point end);
+
+    bool is_enabled();
+    void set_enabled(bool enabled);
+
+    // Recent spans of every thread, oldest first within a thread
+    std::string dump();
+    void clear();
+
+    class Span {
+        public:
+            explicit Span(const char* a_name, const char* a_category = "sscan") :
+                name {a_name},
+                category {a_category},
+                start {is_enabled() ? clock::now() : clock::time_point {}} {}
+
+            ~Span() {
+                if (start != clock::time_point {}) {
+                    record(name, category, start, clock::now());
+                }
+            }
+
+            Span(const Span& other) = delete;
+            Span& operator=(const Span& other) = delete;
+        private:
+            const char* const name;
+            const char* const category;
+            const clock::time_point start;
+    };
+
+}
+
+#endif // SECURITIES_SCANNER_TRACE_H
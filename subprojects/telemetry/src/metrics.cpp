@@ -0,0 +1,241 @@
+#include <sscan/metrics.h>
+
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+using namespace metrics;
+
+namespace {
+
+    size_t shard_index() {
+        static thread_local const size_t index = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return index;
+    }
+
+    void append_number(std::string& out, double value) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void append_number(std::string& out, u_int64_t value) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void append_sample(std::string& out, const std::string& name, const std::string& labels) {
+        out += name;
+        if (!labels.empty()) {
+            out += '{';
+            out += labels;
+            out += '}';
+        }
+        out += ' ';
+    }
+
+}
+
+Counter::Counter() : shards {} {}
+
+void Counter::inc(u_int64_t value) {
+    shards[shard_index() % shards.size()].value.fetch_add(value, std::memory_order_relaxed);
+}
+
+u_int64_t Counter::value() const {
+    u_int64_t sum = 0;
+    for (auto& shard : shards) {
+        sum += shard.value.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+void Counter::render(std::string& out, const std::string& name, const std::string& labels) const {
+    append_sample(out, name, labels);
+    append_number(out, value());
+    out += '\n';
+}
+
+Gauge::Gauge() : current {0} {}
+
+void Gauge::set(double value) {
+    current.store(value, std::memory_order_relaxed);
+}
+
+void Gauge::add(double value) {
+    current.fetch_add(value, std::memory_order_relaxed);
+}
+
+double Gauge::value() const {
+    return current.load(std::memory_order_relaxed);
+}
+
+void Gauge::render(std::string& out, const std::string& name, const std::string& labels) const {
+    append_sample(out, name, labels);
+    append_number(out, value());
+    out += '\n';
+}
+
+Histogram::Histogram(std::vector<double> a_bounds) :
+    bounds {std::move(a_bounds)},
+    buckets {new std::atomic<u_int64_t>[bounds.size() + 1]},
+    total {0} {
+
+    if (!std::is_sorted(bounds.begin(), bounds.end())) {
+        throw std::invalid_argument {"Histogram bounds must be sorted"};
+    }
+
+    for (size_t i = 0; i <= bounds.size(); i++) {
+        buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+void Histogram::observe(double value) {
+    auto bucket = std::lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin();
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(value, std::memory_order_relaxed);
+}
+
+u_int64_t Histogram::count() const {
+    u_int64_t count = 0;
+    for (size_t i = 0; i <= bounds.size(); i++) {
+        count += buckets[i].load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+double Histogram::sum() const {
+    return total.load(std::memory_order_relaxed);
+}
+
+void Histogram::render(std::string& out, const std::string& name, const std::string& labels) const {
+    auto separator = labels.empty() ? "" : ",";
+    u_int64_t cumulative = 0;
+    for (size_t i = 0; i <= bounds.size(); i++) {
+        cumulative += buckets[i].load(std::memory_order_relaxed);
+
+        out += name;
+        out += "_bucket{";
+        out += labels;
+        out += separator;
+        out += "le=\"";
+        if (i < bounds.size()) {
+            append_number(out, bounds[i]);
+        } else {
+            out += "+Inf";
+        }
+        out += "\"} ";
+        append_number(out, cumulative);
+        out += '\n';
+    }
+
+    append_sample(out, name + "_sum", labels);
+    append_number(out, sum());
+    out += '\n';
+
+    append_sample(out, name + "_count", labels);
+    append_number(out, cumulative);
+    out += '\n';
+}
+
+const std::vector<double>& metrics::latency_buckets() {
+    static const std::vector<double> bounds {
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30
+    };
+    return bounds;
+}
+
+FamilyBase::FamilyBase(const std::string& a_name, const std::string& a_help, const std::string& a_type, Labels a_label_names) :
+    name {a_name},
+    help {a_help},
+    type {a_type},
+    label_names {std::move(a_label_names)},
+    m {} {}
+
+void FamilyBase::render(std::string& out) const {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+
+    std::shared_lock<std::shared_mutex> rlock(m);
+    render_metrics(out);
+}
+
+std::string FamilyBase::format_labels(const Labels& values) const {
+    auto labels = std::string();
+    for (size_t i = 0; i < label_names.size() && i < values.size(); i++) {
+        if (i > 0) {
+            labels += ',';
+        }
+        labels += label_names[i];
+        labels += "=\"";
+        for (auto c : values[i]) {
+            switch (c) {
+                case '\\': labels += "\\\\"; break;
+                case '"': labels += "\\\""; break;
+                case '\n': labels += "\\n"; break;
+                default: labels += c;
+            }
+        }
+        labels += '"';
+    }
+    return labels;
+}
+
+Registry::Registry() : m {}, families {} {}
+
+Family<Counter>& Registry::counter(const std::string& name, const std::string& help, Labels label_names) {
+    return add<Counter>(name, help, "counter", std::move(label_names));
+}
+
+Family<Gauge>& Registry::gauge(const std::string& name, const std::string& help, Labels label_names) {
+    return add<Gauge>(name, help, "gauge", std::move(label_names));
+}
+
+Family<Histogram>& Registry::histogram(
+    const std::string& name,
+    const std::string& help,
+    Labels label_names,
+    const std::vector<double>& bounds) {
+
+    return add<Histogram>(name, help, "histogram", std::move(label_names), bounds);
+}
+
+template<typename M, typename... Args>
+Family<M>& Registry::add(const std::string& name, const std::string& help, const std::string& type, Labels label_names, Args... args) {
+    std::lock_guard<std::mutex> lock(m);
+    auto& family = families[name];
+    if (!family) {
+        family = std::make_unique<Family<M>>(name, help, type, std::move(label_names), args...);
+    }
+
+    auto typed = dynamic_cast<Family<M>*>(family.get());
+    if (!typed) {
+        throw std::logic_error {"Metric " + name + " is registered with another type"};
+    }
+    return *typed;
+}
+
+std::string Registry::render() const {
+    auto out = std::string();
+    std::lock_guard<std::mutex> lock(m);
+    for (auto& entry : families) {
+        entry.second->render(out);
+    }
+    return out;
+}
+
+Registry& Registry::shared() {
+    static Registry registry;
+    return registry;
+}
+
+Timer::Timer(Histogram& a_histogram) :
+    histogram {a_histogram},
+    started {std::chrono::steady_clock::now()} {}
+
+Timer::~Timer() {
+    histogram.observe(std::chrono::steady_clock::now() - started);
+}
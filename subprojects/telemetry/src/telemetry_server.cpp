@@ -0,0 +1,142 @@
+#include <sscan/telemetry_server.h>
+
+#include <memory>
+#include <boost/asio/ip/address.hpp>
+#include <boost/beast.hpp>
+#include <boost/log/trivial.hpp>
+
+namespace beast = boost::beast;
+namespace asio = boost::asio;
+using tcp = asio::ip::tcp;
+
+const auto TELEMETRY_SERVER_TIMEOUT = std::chrono::seconds(30);
+
+class TelemetryServer::Session : public std::enable_shared_from_this<TelemetryServer::Session> {
+    public:
+        Session(tcp::socket socket, const std::map<std::string, Route, std::less<>>& a_routes) :
+            stream {std::move(socket)},
+            buffer {},
+            request {},
+            response {},
+            routes {a_routes} {}
+
+        void read() {
+            request = {};
+            stream.expires_after(TELEMETRY_SERVER_TIMEOUT);
+            beast::http::async_read(stream, buffer, request,
+                [self = shared_from_this()](beast::error_code ec, size_t) {
+                    if (ec) {
+                        self->close();
+                        return;
+                    }
+
+                    self->respond();
+                });
+        }
+    private:
+        beast::tcp_stream stream;
+        beast::flat_buffer buffer;
+        beast::http::request<beast::http::string_body> request;
+        beast::http::response<beast::http::string_body> response;
+        const std::map<std::string, Route, std::less<>>& routes;
+
+        void respond() {
+            auto target = std::string_view {request.target()};
+            auto query_pos = target.find('?');
+            auto path = target.substr(0, query_pos);
+            auto query = query_pos == std::string_view::npos ? std::string_view {} : target.substr(query_pos + 1);
+
+            response = {};
+            response.version(request.version());
+            response.keep_alive(request.keep_alive());
+
+            auto route_it = routes.find(path);
+            if (request.method() != beast::http::verb::get) {
+                response.result(beast::http::status::method_not_allowed);
+            } else if (route_it == routes.end()) {
+                response.result(beast::http::status::not_found);
+            } else {
+                try {
+                    response.body() = route_it->second.handler(query);
+                    response.result(beast::http::status::ok);
+                    response.set(beast::http::field::content_type, route_it->second.content_type);
+                } catch (const std::exception& ex) {
+                    response.result(beast::http::status::internal_server_error);
+                    response.body() = ex.what();
+                }
+            }
+            response.prepare_payload();
+
+            beast::http::async_write(stream, response,
+                [self = shared_from_this()](beast::error_code ec, size_t) {
+                    if (ec || !self->response.keep_alive()) {
+                        self->close();
+                        return;
+                    }
+
+                    self->read();
+                });
+        }
+
+        void close() {
+            beast::error_code ec;
+            stream.socket().shutdown(tcp::socket::shutdown_send, ec);
+        }
+};
+
+TelemetryServer::TelemetryServer(const std::string& a_host, const int a_port) :
+    host {a_host},
+    port {a_port},
+    io {},
+    acceptor {},
+    routes {},
+    thread {} {}
+
+TelemetryServer::~TelemetryServer() {
+    stop();
+}
+
+void TelemetryServer::route(const std::string& path, const std::string& content_type, Handler handler) {
+    routes[path] = Route { .content_type = content_type, .handler = std::move(handler) };
+}
+
+void TelemetryServer::start() {
+    if (port <= 0 || thread.joinable()) {
+        return;
+    }
+
+    auto endpoint = tcp::endpoint {asio::ip::make_address(host), static_cast<unsigned short>(port)};
+    acceptor.emplace(io, endpoint);
+    accept();
+
+    thread = std::thread([this]() {
+        try {
+            io.run();
+        } catch (const std::exception& ex) {
+            BOOST_LOG_TRIVIAL(error) << "Error in telemetry server: " << ex.what();
+        }
+    });
+
+    BOOST_LOG_TRIVIAL(info) << "Telemetry server listening on " << host << ":" << std::to_string(port);
+}
+
+void TelemetryServer::stop() {
+    io.stop();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void TelemetryServer::accept() {
+    acceptor->async_accept([this](beast::error_code ec, tcp::socket socket) {
+        if (ec) {
+            BOOST_LOG_TRIVIAL(warning) << "Telemetry server accept: " << ec.message();
+        } else {
+            std::make_shared<Session>(std::move(socket), routes)->read();
+        }
+
+        if (acceptor->is_open()) {
+            accept();
+        }
+    });
+}
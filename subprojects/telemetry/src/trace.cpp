@@ -0,0 +1,189 @@
+#include <sscan/trace.h>
+
+#include <array>
+#include <charconv>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+    const size_t TRACE_BUFFER_SPANS = 16384;
+
+    std::atomic<bool> enabled {false};
+    const auto epoch = trace::clock::now();
+
+    // Slots are guarded by a sequence number: odd while the owning thread
+    // writes it, 2 * (index + 1) once span number index is complete. Readers
+    // drop slots that were overwritten while being copied.
+    struct Slot {
+        std::atomic<u_int64_t> seq;
+        std::atomic<const char*> name;
+        std::atomic<const char*> category;
+        std::atomic<int64_t> start_ns;
+        std::atomic<int64_t> duration_ns;
+    };
+
+    struct SpanRecord {
+        const char* name;
+        const char* category;
+        int64_t start_ns;
+        int64_t duration_ns;
+    };
+
+    // Written only by its thread, read by dump() from any thread
+    struct Buffer {
+        const u_int64_t tid;
+        std::atomic<u_int64_t> head;
+        std::atomic<u_int64_t> tail;
+        std::array<Slot, TRACE_BUFFER_SPANS> slots;
+
+        explicit Buffer(u_int64_t a_tid) : tid {a_tid}, head {0}, tail {0}, slots {} {}
+
+        void push(const char* name, const char* category, int64_t start_ns, int64_t duration_ns) {
+            auto index = head.load(std::memory_order_relaxed);
+            auto& slot = slots[index % slots.size()];
+
+            slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.name.store(name, std::memory_order_relaxed);
+            slot.category.store(category, std::memory_order_relaxed);
+            slot.start_ns.store(start_ns, std::memory_order_relaxed);
+            slot.duration_ns.store(duration_ns, std::memory_order_relaxed);
+            slot.seq.store(2 * (index + 1), std::memory_order_release);
+
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        void read(std::vector<SpanRecord>& spans) const {
+            auto end = head.load(std::memory_order_acquire);
+            auto begin = std::max(tail.load(std::memory_order_relaxed), end > slots.size() ? end - slots.size() : 0);
+
+            for (auto index = begin; index < end; index++) {
+                auto& slot = slots[index % slots.size()];
+                auto seq = slot.seq.load(std::memory_order_acquire);
+                auto span = SpanRecord {
+                    .name = slot.name.load(std::memory_order_relaxed),
+                    .category = slot.category.load(std::memory_order_relaxed),
+                    .start_ns = slot.start_ns.load(std::memory_order_relaxed),
+                    .duration_ns = slot.duration_ns.load(std::memory_order_relaxed)
+                };
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (seq != 2 * (index + 1) || slot.seq.load(std::memory_order_relaxed) != seq) {
+                    continue;
+                }
+
+                spans.push_back(span);
+            }
+        }
+    };
+
+    std::mutex buffers_m;
+    std::vector<std::shared_ptr<Buffer>> buffers;
+    // Buffers of exited threads, so short-lived workers do not grow the list.
+    // A reused buffer keeps the spans and the tid of its previous thread.
+    std::vector<std::shared_ptr<Buffer>> free_buffers;
+
+    struct BufferOwner {
+        std::shared_ptr<Buffer> buffer;
+
+        BufferOwner() {
+            std::lock_guard<std::mutex> lock(buffers_m);
+            if (!free_buffers.empty()) {
+                buffer = std::move(free_buffers.back());
+                free_buffers.pop_back();
+                return;
+            }
+
+            buffer = std::make_shared<Buffer>(buffers.size() + 1);
+            buffers.push_back(buffer);
+        }
+
+        ~BufferOwner() {
+            std::lock_guard<std::mutex> lock(buffers_m);
+            free_buffers.push_back(std::move(buffer));
+        }
+    };
+
+    Buffer& thread_buffer() {
+        static thread_local BufferOwner owner;
+        return *owner.buffer;
+    }
+
+    void append_escaped(std::string& out, const char* value) {
+        for (auto c = value; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\') {
+                out += '\\';
+            }
+            out += *c;
+        }
+    }
+
+    // Chrome expects microseconds
+    void append_us(std::string& out, int64_t ns) {
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), ns / 1000.0, std::chars_format::fixed, 3);
+        out.append(buffer, result.ptr);
+    }
+
+}
+
+void trace::record(const char* name, const char* category, clock::time_point start, clock::time_point end) {
+    if (!is_enabled()) {
+        return;
+    }
+
+    thread_buffer().push(name, category,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+bool trace::is_enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void trace::set_enabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+std::string trace::dump() {
+    auto snapshot = std::vector<std::shared_ptr<Buffer>>();
+    {
+        std::lock_guard<std::mutex> lock(buffers_m);
+        snapshot = buffers;
+    }
+
+    auto out = std::string("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    auto spans = std::vector<SpanRecord>();
+    bool first = true;
+    for (auto& buffer : snapshot) {
+        spans.clear();
+        buffer->read(spans);
+
+        auto tid = std::to_string(buffer->tid);
+        for (auto& span : spans) {
+            out += first ? "{\"name\":\"" : ",{\"name\":\"";
+            first = false;
+            append_escaped(out, span.name);
+            out += "\",\"cat\":\"";
+            append_escaped(out, span.category);
+            out += "\",\"ph\":\"X\",\"pid\":1,\"tid\":";
+            out += tid;
+            out += ",\"ts\":";
+            append_us(out, span.start_ns);
+            out += ",\"dur\":";
+            append_us(out, span.duration_ns);
+            out += '}';
+        }
+    }
+    out += "]}";
+
+    return out;
+}
+
+void trace::clear() {
+    std::lock_guard<std::mutex> lock(buffers_m);
+    for (auto& buffer : buffers) {
+        buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
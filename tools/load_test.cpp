@@ -0,0 +1,110 @@
+// Runs the full BondsLoader -> Scanner -> Notifier path against tools/mock_broker
+// for a fixed time and prints a json report: how long the universe took to load,
+// price cycle throughput from the scanner's own metrics, and the end-to-end alert
+// latency measured by the mock. The config should point every host at the mock
+// and set scanner.ignore-working-hours.
+
+#include <sscan/scanner.h>
+#include <sscan/notifier.h>
+#include <sscan/metrics.h>
+#include <sscan/http.h>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <boost/program_options.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+
+namespace logging = boost::log;
+namespace opts = boost::program_options;
+
+using clock_type = std::chrono::steady_clock;
+
+u_int64_t counter_value(const std::string& name, const std::string& source) {
+    return metrics::Registry::shared().counter(name, "", {"source"}).with({source}).value();
+}
+
+u_int64_t price_cycles(const std::string& source) {
+    return metrics::Registry::shared().histogram("sscan_price_phase_seconds", "", {"source", "phase"})
+        .with({source, "total"}).count();
+}
+
+int main(int argc, const char *argv[]) {
+    try {
+        opts::options_description desc{"Options"};
+        desc.add_options()
+            ("config", opts::value<std::string>()->default_value("load_test.yml"), "Config file")
+            ("duration-s", opts::value<int>()->default_value(60), "How long the scanner runs")
+            ("log-level", opts::value<std::string>()->default_value("warning"), "Scanner log level");
+
+        opts::variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+
+        Config config = Config::load(vm["config"].as<std::string>());
+        if (!config.scanner.ignore_working_hours) {
+            std::cerr << "scanner.ignore-working-hours is off, prices are only polled in working hours" << std::endl;
+        }
+
+        logging::trivial::severity_level severity;
+        std::istringstream{vm["log-level"].as<std::string>()} >> severity;
+        logging::core::get()->set_filter(logging::trivial::severity >= severity);
+
+        if (!config.http.record_path.empty()) {
+            http::Recorder::set_shared(std::make_shared<http::Recorder>(config.http.record_path));
+        }
+
+        BondsLoader bonds_loader {config};
+        PriceLoader price_loader {config};
+        boost::asio::thread_pool thread_pool(16);
+
+        Notifier notifier {config, thread_pool};
+        notifier.start();
+
+        Scanner scanner {config, bonds_loader, price_loader, notifier, thread_pool};
+
+        // The scanner has no stop, the process exits once the report is out
+        auto started = clock_type::now();
+        std::thread([&scanner]() { scanner.start(); }).detach();
+
+        auto& universe = metrics::Registry::shared().gauge("sscan_universe_bonds", "").with({});
+        auto deadline = started + std::chrono::seconds(vm["duration-s"].as<int>());
+        std::optional<double> universe_loaded_s;
+        while (clock_type::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (!universe_loaded_s.has_value() && universe.value() > 0) {
+                universe_loaded_s = std::chrono::duration<double>(clock_type::now() - started).count();
+            }
+        }
+
+        auto elapsed = std::chrono::duration<double>(clock_type::now() - started).count();
+        auto prices_window = elapsed - universe_loaded_s.value_or(elapsed);
+        auto prices = counter_value("sscan_prices_total", "poll") + counter_value("sscan_prices_total", "stream");
+
+        std::string mock_stats = "null";
+        try {
+            http::HttpClient client {config.broker.host};
+            mock_stats = client.get("/mock/stats");
+        } catch (const std::exception& ex) {
+            std::cerr << "Mock stats unavailable: " << ex.what() << std::endl;
+        }
+
+        std::cout << "{\"duration_s\": " << elapsed
+            << ", \"universe_bonds\": " << universe.value()
+            << ", \"universe_loaded_s\": " << (universe_loaded_s.has_value() ? std::to_string(universe_loaded_s.value()) : "null")
+            << ", \"price_cycles\": " << price_cycles("poll")
+            << ", \"tick_batches\": " << price_cycles("stream")
+            << ", \"prices\": " << prices
+            << ", \"prices_per_s\": " << (prices_window > 0 ? prices / prices_window : 0)
+            << ", \"price_changes\": " << counter_value("sscan_prices_changed_total", "poll") + counter_value("sscan_prices_changed_total", "stream")
+            << ", \"alerts\": " << counter_value("sscan_alerts_total", "poll") + counter_value("sscan_alerts_total", "stream")
+            << ", \"mock\": " << mock_stats << "}" << std::endl;
+
+        std::quick_exit(0);
+    }
+    catch (const std::exception &ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,654 @@
+// Local stand-in for the broker's REST API, the rank site and the Telegram Bot
+// API, so the whole BondsLoader -> Scanner -> Notifier path can be load-tested
+// without credentials. Responses are synthesised for a seeded universe of
+// instruments, or replayed from a file recorded with http.record-path.
+//
+// Every hot-interval-ms one instrument drops to half its price; the delay until
+// a sendMessage mentioning its ISIN arrives is the end-to-end latency reported
+// by GET /mock/stats. Point broker.host, rank.host and tgbot.api-url at the mock
+// and use rank.regex "RU[0-9]{10}". tgbot-cpp always connects on port 443, so
+// listen there as well when Telegram is mocked.
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/program_options.hpp>
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include <json/json.h>
+
+namespace beast = boost::beast;
+namespace asio = boost::asio;
+namespace ssl = asio::ssl;
+namespace opts = boost::program_options;
+
+using tcp = asio::ip::tcp;
+using clock_type = std::chrono::steady_clock;
+using request_t = beast::http::request<beast::http::string_body>;
+using response_t = beast::http::response<beast::http::string_body>;
+
+const auto HOT_TIMEOUT = std::chrono::seconds(30);
+const auto LONG_POLL_DELAY = std::chrono::seconds(1);
+
+struct MockOptions {
+    std::chrono::milliseconds latency;
+    std::chrono::milliseconds jitter;
+    double error_rate;
+    int rps;
+    int burst;
+    size_t page_size;
+    double drift_rate;
+};
+
+struct Instrument {
+    std::string isin;
+    std::string uid;
+    std::string name;
+    long nominal;
+    long coupon;
+    int dtm;
+    bool rejected;
+    // Hundredths of a percent of nominal
+    long price;
+};
+
+struct MockResponse {
+    unsigned int status;
+    std::string body;
+    std::chrono::milliseconds delay;
+};
+
+struct HotPrice {
+    size_t index;
+    long price;
+    clock_type::time_point injected;
+};
+
+std::string format_quotation(long hundredths) {
+    return "{\"units\":\"" + std::to_string(hundredths / 100) + "\",\"nano\":" + std::to_string(hundredths % 100 * 10000000) + "}";
+}
+
+std::string format_date(std::chrono::system_clock::time_point time) {
+    auto seconds = std::chrono::system_clock::to_time_t(time);
+    std::ostringstream out;
+    out << std::put_time(std::gmtime(&seconds), "%FT%TZ");
+    return out.str();
+}
+
+// Value of a string member in the compact json sent by the scanner
+std::string string_member(std::string_view json, std::string_view key) {
+    auto pattern = "\"" + std::string {key} + "\":\"";
+    auto pos = json.find(pattern);
+    if (pos == std::string_view::npos) {
+        return {};
+    }
+    pos += pattern.size();
+    return std::string {json.substr(pos, json.find('"', pos) - pos)};
+}
+
+// Every quoted uuid in the body, in order
+std::vector<std::string> uuid_strings(std::string_view json) {
+    auto uids = std::vector<std::string>();
+    for (auto pos = json.find('"'); pos != std::string_view::npos; ) {
+        auto end = json.find('"', pos + 1);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        if (end - pos - 1 == 36 && json[pos + 9] == '-') {
+            uids.emplace_back(json.substr(pos + 1, 36));
+        }
+        pos = json.find('"', end + 1);
+    }
+    return uids;
+}
+
+class Broker {
+    public:
+        Broker(size_t size, unsigned int seed, const MockOptions& a_options) :
+            options {a_options},
+            random {seed},
+            instruments {},
+            by_isin {},
+            by_uid {},
+            replay {},
+            tokens {static_cast<double>(std::max(a_options.burst, 1))},
+            refilled {clock_type::now()},
+            hot {},
+            requests {},
+            throttled {0},
+            errors {0},
+            replayed {0},
+            messages {0},
+            alerts {0},
+            missed {0},
+            latencies {} {
+
+            auto uid_generator = boost::uuids::basic_random_generator<std::mt19937> {random};
+            auto nominal = std::uniform_int_distribution<int> {1, 10};
+            auto rate = std::uniform_int_distribution<int> {5, 15};
+            auto dtm = std::uniform_int_distribution<int> {30, 1800};
+            auto price = std::uniform_int_distribution<long> {9000, 10200};
+
+            for (size_t i = 0; i < size; i++) {
+                std::ostringstream isin;
+                isin << "RU" << std::setw(10) << std::setfill('0') << i + 1;
+
+                auto bond_nominal = nominal(random) * 100000L;
+                auto instrument = Instrument {
+                    .isin = isin.str(),
+                    .uid = boost::uuids::to_string(uid_generator()),
+                    .name = "Mock bond " + std::to_string(i + 1),
+                    .nominal = bond_nominal,
+                    .coupon = bond_nominal * rate(random) / 200,
+                    .dtm = dtm(random),
+                    .rejected = i % 20 == 19,
+                    .price = price(random)
+                };
+                by_isin[instrument.isin] = i;
+                by_uid[instrument.uid] = i;
+                instruments.push_back(std::move(instrument));
+            }
+        }
+
+        void load_replay(const std::string& path) {
+            std::ifstream in {path};
+            if (!in) {
+                throw std::runtime_error {"Unable to open " + path};
+            }
+
+            std::string line;
+            size_t loaded = 0;
+            while (std::getline(in, line)) {
+                Json::Value exchange;
+                Json::Reader reader;
+                if (line.empty() || !reader.parse(line, exchange)) {
+                    continue;
+                }
+
+                auto key = replay_key(exchange["method"].asString(), exchange["target"].asString(), exchange["request"].asString());
+                replay[key].push_back(MockResponse {
+                    .status = exchange["status"].asUInt(),
+                    .body = exchange["response"].asString(),
+                    .delay = {}
+                });
+                loaded++;
+            }
+
+            std::cout << "Replaying " << loaded << " exchanges from " << path << std::endl;
+        }
+
+        MockResponse handle(const request_t& request) {
+            auto target = std::string {request.target()};
+            auto method = std::string {request.method_string()};
+            auto& body = request.body();
+
+            std::lock_guard<std::mutex> lock(m);
+            expire_hot();
+
+            if (target == "/mock/stats") {
+                return respond(200, stats_json(), std::chrono::milliseconds(0));
+            }
+            if (target.starts_with("/bot")) {
+                return handle_telegram(target, body);
+            }
+
+            auto endpoint = endpoint_name(target);
+            requests[endpoint]++;
+
+            if (!take_token()) {
+                throttled++;
+                return respond(429, "{\"code\":8,\"message\":\"rate limit exceeded\"}", latency());
+            }
+            if (std::uniform_real_distribution<double> {0, 1}(random) < options.error_rate) {
+                errors++;
+                return respond(500, "{\"code\":13,\"message\":\"internal error\"}", latency());
+            }
+
+            auto replay_it = replay.find(replay_key(method, target, body));
+            if (replay_it != replay.end()) {
+                replayed++;
+                auto response = replay_it->second.front();
+                replay_it->second.pop_front();
+                replay_it->second.push_back(response);
+                response.delay = latency();
+                return response;
+            }
+
+            if (endpoint == "BondBy") {
+                return bond_by(body);
+            }
+            if (endpoint == "GetAccruedInterests") {
+                return accrued_interests(body);
+            }
+            if (endpoint == "GetBondCoupons") {
+                return bond_coupons(body);
+            }
+            if (endpoint == "GetLastPrices") {
+                return last_prices(body);
+            }
+            if (endpoint == "GetOrderBook") {
+                return order_book(body);
+            }
+            return rank_page(target);
+        }
+
+        void inject() {
+            std::lock_guard<std::mutex> lock(m);
+            expire_hot();
+            if (instruments.empty()) {
+                return;
+            }
+
+            auto index = std::uniform_int_distribution<size_t> {0, instruments.size() - 1}(random);
+            auto& instrument = instruments[index];
+            if (instrument.rejected || instrument.dtm < 90 || hot.contains(instrument.isin)) {
+                return;
+            }
+
+            hot[instrument.isin] = HotPrice { .index = index, .price = instrument.price, .injected = clock_type::now() };
+            instrument.price /= 2;
+        }
+    private:
+        const MockOptions options;
+        std::mutex m;
+        std::mt19937 random;
+        std::vector<Instrument> instruments;
+        std::unordered_map<std::string, size_t> by_isin;
+        std::unordered_map<std::string, size_t> by_uid;
+        std::unordered_map<std::string, std::deque<MockResponse>> replay;
+
+        double tokens;
+        clock_type::time_point refilled;
+        std::unordered_map<std::string, HotPrice> hot;
+
+        std::map<std::string, u_int64_t> requests;
+        u_int64_t throttled;
+        u_int64_t errors;
+        u_int64_t replayed;
+        u_int64_t messages;
+        u_int64_t alerts;
+        u_int64_t missed;
+        std::vector<double> latencies;
+
+        static std::string replay_key(const std::string& method, const std::string& target, const std::string& body) {
+            return method + " " + target + "\n" + body;
+        }
+
+        // Last path segment of the broker's grpc gateway paths
+        static std::string endpoint_name(const std::string& target) {
+            auto path = target.substr(0, target.find('?'));
+            return path.substr(path.rfind('/') + 1);
+        }
+
+        MockResponse respond(unsigned int status, std::string body, std::chrono::milliseconds delay) {
+            return MockResponse { .status = status, .body = std::move(body), .delay = delay };
+        }
+
+        std::chrono::milliseconds latency() {
+            auto jitter = options.jitter.count() > 0
+                ? std::uniform_int_distribution<long> {0, options.jitter.count()}(random)
+                : 0;
+            return options.latency + std::chrono::milliseconds(jitter);
+        }
+
+        bool take_token() {
+            if (options.rps <= 0) {
+                return true;
+            }
+
+            auto now = clock_type::now();
+            tokens = std::min<double>(std::max(options.burst, 1),
+                tokens + std::chrono::duration<double>(now - refilled).count() * options.rps);
+            refilled = now;
+            if (tokens < 1) {
+                return false;
+            }
+            tokens -= 1;
+            return true;
+        }
+
+        const Instrument* find_uid(const std::string& uid) const {
+            auto it = by_uid.find(uid);
+            return it == by_uid.end() ? nullptr : &instruments[it->second];
+        }
+
+        MockResponse bond_by(const std::string& body) {
+            auto it = by_isin.find(string_member(body, "id"));
+            if (it == by_isin.end()) {
+                return respond(404, "{\"code\":5,\"message\":\"instrument not found\"}", latency());
+            }
+
+            auto& instrument = instruments[it->second];
+            auto maturity = std::chrono::system_clock::now() + std::chrono::days(instrument.dtm);
+            auto json = "{\"instrument\":{\"isin\":\"" + instrument.isin
+                + "\",\"uid\":\"" + instrument.uid
+                + "\",\"name\":\"" + instrument.name
+                + "\",\"nominal\":{\"currency\":\"rub\",\"units\":\"" + std::to_string(instrument.nominal / 100)
+                + "\",\"nano\":0},\"buyAvailableFlag\":true,\"sellAvailableFlag\":true,\"floatingCouponFlag\":false"
+                + ",\"amortizationFlag\":" + (instrument.rejected ? "true" : "false")
+                + ",\"subordinatedFlag\":false,\"forIisFlag\":true,\"maturityDate\":\"" + format_date(maturity) + "\"}}";
+            return respond(200, std::move(json), latency());
+        }
+
+        MockResponse accrued_interests(const std::string& body) {
+            auto instrument = find_uid(string_member(body, "instrumentId"));
+            if (!instrument) {
+                return respond(200, "{\"accruedInterests\":[]}", latency());
+            }
+
+            auto accrued = instrument->coupon * (182 - instrument->dtm % 182) / 182;
+            auto json = "{\"accruedInterests\":[{\"date\":\"" + format_date(std::chrono::system_clock::now())
+                + "\",\"value\":" + format_quotation(accrued) + "}]}";
+            return respond(200, std::move(json), latency());
+        }
+
+        MockResponse bond_coupons(const std::string& body) {
+            auto instrument = find_uid(string_member(body, "instrumentId"));
+            if (!instrument) {
+                return respond(200, "{\"events\":[]}", latency());
+            }
+
+            auto now = std::chrono::system_clock::now();
+            auto json = std::string("{\"events\":[");
+            for (int days = instrument->dtm; days > 1; days -= 182) {
+                json += json.back() == '[' ? "" : ",";
+                json += "{\"fixDate\":\"" + format_date(now + std::chrono::days(days))
+                    + "\",\"payOneBond\":" + format_quotation(instrument->coupon) + "}";
+            }
+            json += "]}";
+            return respond(200, std::move(json), latency());
+        }
+
+        MockResponse last_prices(const std::string& body) {
+            auto drift = std::uniform_real_distribution<double> {0, 1};
+            auto step = std::uniform_int_distribution<long> {-5, 5};
+            auto time = format_date(std::chrono::system_clock::now());
+
+            auto json = std::string("{\"lastPrices\":[");
+            for (auto& uid : uuid_strings(body)) {
+                auto it = by_uid.find(uid);
+                if (it == by_uid.end()) {
+                    continue;
+                }
+
+                auto& instrument = instruments[it->second];
+                if (!hot.contains(instrument.isin) && drift(random) < options.drift_rate) {
+                    instrument.price = std::max(100L, instrument.price + step(random));
+                }
+
+                json += json.back() == '[' ? "" : ",";
+                json += "{\"figi\":\"\",\"price\":" + format_quotation(instrument.price)
+                    + ",\"time\":\"" + time + "\",\"instrumentUid\":\"" + instrument.uid
+                    + "\",\"lastPriceType\":\"LAST_PRICE_EXCHANGE\"}";
+            }
+            json += "]}";
+            return respond(200, std::move(json), latency());
+        }
+
+        MockResponse order_book(const std::string& body) {
+            auto instrument = find_uid(string_member(body, "instrumentId"));
+            if (!instrument) {
+                return respond(404, "{\"code\":5,\"message\":\"instrument not found\"}", latency());
+            }
+
+            auto json = "{\"depth\":1,\"bids\":[{\"price\":" + format_quotation(instrument->price - 5)
+                + ",\"quantity\":\"10\"}],\"asks\":[{\"price\":" + format_quotation(instrument->price)
+                + ",\"quantity\":\"10\"}],\"lastPrice\":" + format_quotation(instrument->price)
+                + ",\"instrumentUid\":\"" + instrument->uid + "\"}";
+            return respond(200, std::move(json), latency());
+        }
+
+        // Page number is the last run of digits in the path, pages past the universe are empty
+        MockResponse rank_page(const std::string& target) {
+            auto digits_end = target.find_last_of("0123456789");
+            size_t page = 1;
+            if (digits_end != std::string::npos) {
+                auto digits_begin = target.find_last_not_of("0123456789", digits_end) + 1;
+                page = std::max<size_t>(std::stoul(target.substr(digits_begin, digits_end - digits_begin + 1)), 1);
+            }
+
+            auto html = std::string("<html><body>\n");
+            auto first = (page - 1) * options.page_size;
+            for (auto i = first; i < std::min(first + options.page_size, instruments.size()); i++) {
+                html += "<a href=\"/bonds/" + instruments[i].isin + "\">" + instruments[i].name + "</a>\n";
+            }
+            html += "</body></html>\n";
+            return respond(200, std::move(html), latency());
+        }
+
+        MockResponse handle_telegram(const std::string& target, const std::string& body) {
+            if (target.ends_with("/getUpdates")) {
+                return respond(200, "{\"ok\":true,\"result\":[]}", LONG_POLL_DELAY);
+            }
+
+            if (target.ends_with("/sendMessage")) {
+                messages++;
+                auto now = clock_type::now();
+                for (auto it = hot.begin(); it != hot.end(); ) {
+                    if (body.find(it->first) == std::string::npos) {
+                        it++;
+                        continue;
+                    }
+
+                    alerts++;
+                    latencies.push_back(std::chrono::duration<double, std::milli>(now - it->second.injected).count());
+                    instruments[it->second.index].price = it->second.price;
+                    it = hot.erase(it);
+                }
+
+                auto json = "{\"ok\":true,\"result\":{\"message_id\":" + std::to_string(messages)
+                    + ",\"date\":" + std::to_string(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()))
+                    + ",\"chat\":{\"id\":1,\"type\":\"private\"},\"text\":\"\"}}";
+                return respond(200, std::move(json), latency());
+            }
+
+            return respond(200, "{\"ok\":true,\"result\":true}", latency());
+        }
+
+        void expire_hot() {
+            auto now = clock_type::now();
+            for (auto it = hot.begin(); it != hot.end(); ) {
+                if (now - it->second.injected < HOT_TIMEOUT) {
+                    it++;
+                    continue;
+                }
+
+                missed++;
+                instruments[it->second.index].price = it->second.price;
+                it = hot.erase(it);
+            }
+        }
+
+        std::string stats_json() const {
+            auto sorted = latencies;
+            std::sort(sorted.begin(), sorted.end());
+            auto percentile = [&](double p) {
+                return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()))];
+            };
+
+            std::ostringstream out;
+            out << "{\"requests\":{";
+            for (auto it = requests.begin(); it != requests.end(); it++) {
+                out << (it == requests.begin() ? "" : ",") << "\"" << it->first << "\":" << it->second;
+            }
+            out << "},\"throttled\":" << throttled
+                << ",\"errors\":" << errors
+                << ",\"replayed\":" << replayed
+                << ",\"messages\":" << messages
+                << ",\"alerts\":" << alerts
+                << ",\"missed\":" << missed
+                << ",\"latency_ms\":{\"p50\":" << percentile(0.5)
+                << ",\"p90\":" << percentile(0.9)
+                << ",\"p99\":" << percentile(0.99)
+                << ",\"max\":" << (sorted.empty() ? 0.0 : sorted.back()) << "}}";
+            return out.str();
+        }
+};
+
+class Session : public std::enable_shared_from_this<Session> {
+    public:
+        Session(tcp::socket socket, ssl::context& ssl, Broker& a_broker) :
+            stream {std::move(socket), ssl},
+            timer {stream.get_executor()},
+            broker {a_broker} {}
+
+        void start() {
+            stream.async_handshake(ssl::stream_base::server, [self = shared_from_this()](beast::error_code ec) {
+                if (ec) {
+                    std::cerr << "Handshake: " << ec.message() << std::endl;
+                    return;
+                }
+
+                self->read();
+            });
+        }
+    private:
+        beast::ssl_stream<beast::tcp_stream> stream;
+        asio::steady_timer timer;
+        Broker& broker;
+        beast::flat_buffer buffer;
+        request_t request;
+        response_t response;
+
+        void read() {
+            request = {};
+            beast::http::async_read(stream, buffer, request, [self = shared_from_this()](beast::error_code ec, size_t) {
+                if (ec) {
+                    return;
+                }
+
+                self->respond();
+            });
+        }
+
+        void respond() {
+            auto result = broker.handle(request);
+
+            response = {};
+            response.version(request.version());
+            response.keep_alive(request.keep_alive());
+            response.result(result.status);
+            response.set(beast::http::field::content_type, "application/json");
+            if (result.status == 429) {
+                response.set("x-ratelimit-reset", "1");
+            }
+            response.body() = std::move(result.body);
+            response.prepare_payload();
+
+            timer.expires_after(result.delay);
+            timer.async_wait([self = shared_from_this()](beast::error_code) {
+                beast::http::async_write(self->stream, self->response, [self](beast::error_code ec, size_t) {
+                    if (ec || !self->response.keep_alive()) {
+                        return;
+                    }
+
+                    self->read();
+                });
+            });
+        }
+};
+
+void accept(tcp::acceptor& acceptor, ssl::context& ssl, Broker& broker) {
+    acceptor.async_accept([&acceptor, &ssl, &broker](beast::error_code ec, tcp::socket socket) {
+        if (!ec) {
+            std::make_shared<Session>(std::move(socket), ssl, broker)->start();
+        }
+        accept(acceptor, ssl, broker);
+    });
+}
+
+void schedule_injection(asio::steady_timer& timer, Broker& broker, const std::chrono::milliseconds interval) {
+    timer.expires_after(interval);
+    timer.async_wait([&timer, &broker, interval](beast::error_code ec) {
+        if (ec) {
+            return;
+        }
+
+        broker.inject();
+        schedule_injection(timer, broker, interval);
+    });
+}
+
+int main(int argc, const char *argv[]) {
+    try {
+        opts::options_description desc{"Options"};
+        desc.add_options()
+            ("host", opts::value<std::string>()->default_value("127.0.0.1"), "Listen address")
+            ("port", opts::value<std::vector<unsigned short>>()->multitoken(), "Listen ports, 8443 by default")
+            ("cert", opts::value<std::string>()->required(), "PEM certificate chain")
+            ("key", opts::value<std::string>()->required(), "PEM private key")
+            ("instruments", opts::value<size_t>()->default_value(1000), "Synthetic universe size")
+            ("page-size", opts::value<size_t>()->default_value(100), "ISINs per rank page")
+            ("replay", opts::value<std::string>(), "Recorded exchanges to serve before synthesising")
+            ("latency-ms", opts::value<int>()->default_value(20), "Delay before every response")
+            ("jitter-ms", opts::value<int>()->default_value(10), "Random extra delay up to this")
+            ("error-rate", opts::value<double>()->default_value(0), "Share of broker requests answered with 500")
+            ("rps", opts::value<int>()->default_value(0), "Broker requests per second before 429, 0 for no limit")
+            ("burst", opts::value<int>()->default_value(1), "Requests allowed above rps at once")
+            ("drift-rate", opts::value<double>()->default_value(0.05), "Chance that a price moves when it is requested")
+            ("hot-interval-ms", opts::value<int>()->default_value(5000), "Delay between injected price drops")
+            ("threads", opts::value<int>()->default_value(2), "IO threads")
+            ("seed", opts::value<unsigned int>()->default_value(1), "Random seed");
+
+        opts::variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+
+        auto options = MockOptions {
+            .latency = std::chrono::milliseconds(vm["latency-ms"].as<int>()),
+            .jitter = std::chrono::milliseconds(vm["jitter-ms"].as<int>()),
+            .error_rate = vm["error-rate"].as<double>(),
+            .rps = vm["rps"].as<int>(),
+            .burst = vm["burst"].as<int>(),
+            .page_size = std::max<size_t>(vm["page-size"].as<size_t>(), 1),
+            .drift_rate = vm["drift-rate"].as<double>()
+        };
+
+        Broker broker {vm["instruments"].as<size_t>(), vm["seed"].as<unsigned int>(), options};
+        if (vm.count("replay")) {
+            broker.load_replay(vm["replay"].as<std::string>());
+        }
+
+        asio::io_context io;
+        ssl::context ssl {ssl::context::tls_server};
+        ssl.use_certificate_chain_file(vm["cert"].as<std::string>());
+        ssl.use_private_key_file(vm["key"].as<std::string>(), ssl::context::pem);
+
+        auto host = vm["host"].as<std::string>();
+        auto ports = vm.count("port") ? vm["port"].as<std::vector<unsigned short>>() : std::vector<unsigned short> {8443};
+        auto acceptors = std::vector<std::unique_ptr<tcp::acceptor>>();
+        for (auto port : ports) {
+            acceptors.push_back(std::make_unique<tcp::acceptor>(io, tcp::endpoint {asio::ip::make_address(host), port}));
+            accept(*acceptors.back(), ssl, broker);
+            std::cout << "Mock broker listening on " << host << ":" << port << std::endl;
+        }
+
+        asio::steady_timer injection {io};
+        schedule_injection(injection, broker, std::chrono::milliseconds(std::max(vm["hot-interval-ms"].as<int>(), 1)));
+
+        auto threads = std::vector<std::jthread>();
+        for (int i = 1; i < std::max(vm["threads"].as<int>(), 1); i++) {
+            threads.emplace_back([&io]() { io.run(); });
+        }
+        io.run();
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,183 @@
+// Local stand-in for the broker's market data websocket. Accepts last price
+// subscriptions in the broker's json format and emits random-walk lastPrice
+// messages for the subscribed instruments, so the streaming price mode can be
+// exercised without broker credentials.
+
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <boost/program_options.hpp>
+
+namespace beast = boost::beast;
+namespace asio = boost::asio;
+namespace ssl = asio::ssl;
+namespace websocket = beast::websocket;
+namespace opts = boost::program_options;
+
+using tcp = asio::ip::tcp;
+using ws_t = websocket::stream<beast::ssl_stream<beast::tcp_stream>>;
+
+class Session : public std::enable_shared_from_this<Session> {
+    public:
+        Session(tcp::socket socket, ssl::context& ssl, const std::chrono::milliseconds a_interval, const unsigned int seed) :
+            ws {std::move(socket), ssl},
+            timer {ws.get_executor()},
+            interval {a_interval},
+            random {seed},
+            prices {},
+            writing {false} {}
+
+        void start() {
+            ws.next_layer().async_handshake(ssl::stream_base::server, [self = shared_from_this()](beast::error_code ec) {
+                if (ec) {
+                    std::cerr << "Handshake: " << ec.message() << std::endl;
+                    return;
+                }
+
+                self->ws.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+                self->ws.set_option(websocket::stream_base::decorator([](websocket::response_type& response) {
+                    response.set(beast::http::field::sec_websocket_protocol, "json");
+                }));
+                self->ws.async_accept([self](beast::error_code ec) {
+                    if (ec) {
+                        std::cerr << "Accept: " << ec.message() << std::endl;
+                        return;
+                    }
+
+                    self->read();
+                    self->tick();
+                });
+            });
+        }
+    private:
+        ws_t ws;
+        asio::steady_timer timer;
+        const std::chrono::milliseconds interval;
+        std::mt19937 random;
+        std::unordered_map<std::string, long> prices;
+        beast::flat_buffer buffer;
+        std::string outgoing;
+        bool writing;
+
+        void read() {
+            ws.async_read(buffer, [self = shared_from_this()](beast::error_code ec, size_t) {
+                if (ec) {
+                    self->timer.cancel();
+                    return;
+                }
+
+                self->on_message(beast::buffers_to_string(self->buffer.data()));
+                self->buffer.consume(self->buffer.size());
+                self->read();
+            });
+        }
+
+        void on_message(const std::string& message) {
+            bool subscribe = message.find("SUBSCRIPTION_ACTION_UNSUBSCRIBE") == std::string::npos;
+
+            constexpr std::string_view key = "\"instrumentId\":\"";
+            size_t count = 0;
+            for (auto pos = message.find(key); pos != std::string::npos; pos = message.find(key, pos)) {
+                pos += key.size();
+                auto end = message.find('"', pos);
+                if (end == std::string::npos) {
+                    break;
+                }
+
+                auto uid = message.substr(pos, end - pos);
+                if (subscribe) {
+                    prices.try_emplace(uid, 900000 + random() % 200000);
+                } else {
+                    prices.erase(uid);
+                }
+                count++;
+                pos = end;
+            }
+
+            std::cout << (subscribe ? "Subscribed: " : "Unsubscribed: ") << count
+                << ", total: " << prices.size() << std::endl;
+        }
+
+        void tick() {
+            timer.expires_after(interval);
+            timer.async_wait([self = shared_from_this()](beast::error_code ec) {
+                if (ec) {
+                    return;
+                }
+
+                self->publish();
+                self->tick();
+            });
+        }
+
+        void publish() {
+            if (prices.empty() || writing) {
+                return;
+            }
+
+            auto it = std::next(prices.begin(), random() % prices.size());
+            it->second = std::max(1L, it->second + static_cast<long>(random() % 2001) - 1000);
+
+            outgoing = "{\"lastPrice\":{\"price\":{\"units\":\"" + std::to_string(it->second / 10000)
+                + "\",\"nano\":" + std::to_string(it->second % 10000 * 100000)
+                + "},\"instrumentUid\":\"" + it->first + "\"}}";
+
+            writing = true;
+            ws.text(true);
+            ws.async_write(asio::buffer(outgoing), [self = shared_from_this()](beast::error_code, size_t) {
+                self->writing = false;
+            });
+        }
+};
+
+void accept(tcp::acceptor& acceptor, ssl::context& ssl, const std::chrono::milliseconds interval, unsigned int& seed) {
+    acceptor.async_accept([&acceptor, &ssl, interval, &seed](beast::error_code ec, tcp::socket socket) {
+        if (!ec) {
+            std::make_shared<Session>(std::move(socket), ssl, interval, seed++)->start();
+        }
+        accept(acceptor, ssl, interval, seed);
+    });
+}
+
+int main(int argc, const char *argv[]) {
+    try {
+        opts::options_description desc{"Options"};
+        desc.add_options()
+            ("port", opts::value<unsigned short>()->default_value(8443), "Listen port")
+            ("cert", opts::value<std::string>()->required(), "PEM certificate chain")
+            ("key", opts::value<std::string>()->required(), "PEM private key")
+            ("interval-ms", opts::value<int>()->default_value(100), "Delay between price updates per connection")
+            ("seed", opts::value<unsigned int>()->default_value(1), "Random seed");
+
+        opts::variables_map vm;
+        store(parse_command_line(argc, argv, desc), vm);
+        notify(vm);
+
+        asio::io_context io;
+        ssl::context ssl {ssl::context::tls_server};
+        ssl.use_certificate_chain_file(vm["cert"].as<std::string>());
+        ssl.use_private_key_file(vm["key"].as<std::string>(), ssl::context::pem);
+
+        auto port = vm["port"].as<unsigned short>();
+        auto interval = std::chrono::milliseconds(vm["interval-ms"].as<int>());
+        auto seed = vm["seed"].as<unsigned int>();
+
+        tcp::acceptor acceptor {io, tcp::endpoint {asio::ip::make_address("127.0.0.1"), port}};
+        accept(acceptor, ssl, interval, seed);
+
+        std::cout << "Price stream server listening on 127.0.0.1:" << port << std::endl;
+        io.run();
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+}